@@ -3,6 +3,7 @@
 import cv2
 import numpy as np
 import py_grid_finder as gr
+import sys
 from math import cos, sin
 from timeit import default_timer as timer
 
@@ -51,6 +52,66 @@ def main(filename):
     out.release()
 
 
+def mainPipelined(filename):
+    """
+    Same as main, but the mask and the square are computed by a C++ pipeline
+    on two other cores (gr.FramePipeline), while this thread reads and draws
+    the frames. The throughput is that of the slowest stage, instead of the
+    sum of all stages.
+    """
+    video = cv2.VideoCapture("../Video/"+filename+".mp4")
+    if not video.isOpened():
+        raise RuntimeError("Unable to open video file " + filename + ".mp4")
+    frame_width = int(video.get(3)) * 2
+    frame_height = int(video.get(4))
+    fps = video.get(cv2.CAP_PROP_FPS) / 4
+    out = cv2.VideoWriter(filename+'.pipelined.out.avi', cv2.VideoWriter_fourcc(
+        'M', 'J', 'P', 'G'), fps, (frame_width, frame_height))
+
+    pipeline = gr.FramePipeline(maskCore=1, finderCore=2)
+    pipeline.start()
+    images = {}  # the frames that are in the pipeline, by sequence number
+    sequence = 0
+
+    def write(result):
+        seq, square, mask = result
+        image = images.pop(seq)
+        drawSquare(square, image)
+        mask = cv2.cvtColor(np.asarray(mask, dtype=np.uint8), cv2.COLOR_GRAY2RGB)
+        outimg = np.concatenate((image, mask), axis=1)
+        out.write(cv2.cvtColor(outimg, cv2.COLOR_RGB2BGR))
+
+    start = timer()
+    result, image = video.read()
+    while result and video.isOpened():
+        image = cv2.cvtColor(image, cv2.COLOR_BGR2RGB)
+        # Wait for the oldest frame if the pipeline is full
+        while not pipeline.push(image):
+            write(pipeline.pop(wait=True))
+        images[sequence] = image
+        sequence += 1
+        # Draw the frames that are done without waiting
+        done = pipeline.pop()
+        while done is not None:
+            write(done)
+            done = pipeline.pop()
+        result, image = video.read()
+    done = pipeline.pop(wait=True)
+    while done is not None:
+        write(done)
+        done = pipeline.pop(wait=True)
+    end = timer()
+    pipeline.stop()
+
+    (mask_frames, mask_time), (gr_frames, gr_time) = pipeline.getStageTimes()
+    print("  Mask           : {:5d} fps".format(round(mask_frames / mask_time)))
+    print("  GridFinder     : {:5d} fps".format(round(gr_frames / gr_time)))
+    print("  Pipelined      : {:5d} fps".format(round(sequence / (end - start))))
+
+    video.release()
+    out.release()
+
+
 def showLine(line, color, image):
     # print(line.getLineCenter())
     # print(line.getAngle())
@@ -65,10 +126,15 @@ def processFrame(image, mask):
     start = timer()
     gf = gr.GridFinder(mask)
     square = gf.findSquare()
-    lines, points = square.lines, square.points
     end = timer()
     time = end - start
 
+    drawSquare(square, image)
+    return image, time
+
+
+def drawSquare(square, image):
+    lines, points = square.lines, square.points
     colors = [(0, 80, 255), (0, 200, 255), (0, 255, 0),
               (255, 255, 0), (255, 150, 0)]
 
@@ -81,8 +147,6 @@ def processFrame(image, mask):
             point = (round(point.x), round(point.y))
             cv2.circle(image, point, 3, (255, 0, 0), -1)
 
-    return image, time
-
 
 def redmask(image):
     start = timer()
@@ -106,5 +170,6 @@ def redmask(image):
 
 
 if __name__ == '__main__':
-    main('DroneCam')
-    main('easy')
+    run = mainPipelined if '--pipeline' in sys.argv else main
+    run('DroneCam')
+    run('easy')
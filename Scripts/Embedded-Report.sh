@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+
+# Size and speed report of the embedded build profile of the grid finder
+# (GRID_FINDER_EMBEDDED=1, see src/grid-finder/include/Config.hpp), compared
+# to the default profile.
+#
+# Usage: Scripts/Embedded-Report.sh [frames]
+#
+# The host compiler builds the embedded benchmark with both profiles, runs
+# them, and prints their code sizes. If arm-none-eabi-g++ is installed, the
+# search is also compiled for a Cortex-M7, and the size of the resulting
+# object file is printed as well.
+
+set -e
+
+cd "$(dirname "$0")/.."
+frames=${1:-2000}
+build=$(mktemp -d)
+trap 'rm -rf "$build"' EXIT
+
+CXX=${CXX:-g++}
+includes="-Isrc/grid-finder/include -Isrc/matrix/include -Isrc/utilities/include"
+common="-std=c++17 -O2 -g0 -Wall -Wextra -Wno-missing-braces -Wno-unknown-pragmas"
+embedded="-DGRID_FINDER_EMBEDDED=1 -fno-exceptions -fno-rtti"
+source=applications/embedded-benchmark/src/EmbeddedBenchmark.cpp
+
+for profile in default embedded; do
+    flags="$common"
+    [ $profile = embedded ] && flags="$flags $embedded"
+    $CXX $flags $includes $source -o "$build/$profile"
+    echo "=== $profile profile ($CXX, host)"
+    size "$build/$profile"
+    "$build/$profile" "$frames"
+    echo
+done
+
+if command -v arm-none-eabi-g++ > /dev/null; then
+    echo "=== embedded profile (arm-none-eabi-g++, Cortex-M7)"
+    arm-none-eabi-g++ $common $embedded $includes \
+        -mcpu=cortex-m7 -mthumb -mfpu=fpv5-d16 -mfloat-abi=hard \
+        -Os -ffunction-sections -fdata-sections \
+        -c $source -o "$build/cortex-m7.o"
+    arm-none-eabi-size "$build/cortex-m7.o"
+else
+    echo "arm-none-eabi-g++ not found, skipping the Cortex-M7 build"
+fi
@@ -0,0 +1,189 @@
+/**
+ * Automatic tuning of the detection parameters.
+ *
+ * Searches for the parameters (see Parameters.hpp) that minimize the mean
+ * latency of GridFinder::findSquare on a labeled mask corpus (see
+ * MaskCorpus.hpp), while keeping the detection rate above a given minimum.
+ * The best parameters are written to a profile file that can be loaded using
+ * readParameters.
+ *
+ * The search is a coordinate descent: starting from the default parameters,
+ * every candidate value of one parameter is tried while keeping the others
+ * fixed, and the fastest one that detects enough frames is kept. This is
+ * repeated for all parameters, until a pass no longer improves the latency.
+ *
+ * Usage: autotune <corpus.gfmc> <profile.txt> [options]
+ *
+ * Options:
+ *   --min-detection-rate <x>   Minimum fraction of labeled frames that must be
+ *                              detected (default: rate of the defaults).
+ *   --corner-tolerance <px>    Max. corner distance to count as detected (10).
+ *   --repeat <n>               Run the corpus n times per candidate, and keep
+ *                              the fastest latency of each frame (3).
+ *   --passes <n>               Maximum number of passes over all parameters (3).
+ *   --start <profile>          Start from this profile instead of the defaults.
+ */
+
+#include <Evaluation.hpp>
+#include <GridFinder.hpp>
+#include <MaskCorpus.hpp>
+#include <Parameters.hpp>
+
+#include <algorithm>  // min, max
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+/// The resolution of the masks (same as the Python module).
+constexpr size_t W = 410;
+constexpr size_t H = 308;
+using Params       = RuntimeParameters<W, H>;
+using GF           = GridFinder<W, H, Params>;
+
+/// A parameter to tune, and the values to try.
+struct Dimension {
+    const char *name;
+    uint Params::*member;
+    std::vector<uint> values;
+};
+
+/// The parameters that are tuned. The other parameters are accuracy
+/// thresholds that have little effect on the latency.
+static const std::vector<Dimension> dimensions = {
+    {"HOUGH_MAX_GAP", &Params::HOUGH_MAX_GAP, {4, 8, 12, 16, 24}},
+    {"HOUGH_ANGLE_STEP", &Params::HOUGH_ANGLE_STEP, {1, 2, 3, 4}},
+    {"ACCURATE_ANGLE_RANGE", &Params::ACCURATE_ANGLE_RANGE, {3, 5, 7, 9, 12}},
+    {"FIRST_LINE_INVALID_HORIZONTAL_JUMP",
+     &Params::FIRST_LINE_INVALID_HORIZONTAL_JUMP,
+     {5, 10, 15, 20, 30}},
+};
+
+/// The result of evaluating one set of parameters.
+struct Trial {
+    Params params;
+    EvaluationSummary summary;
+    double meanLatency = 0;  ///< µs
+};
+
+static Trial evaluate(const MaskCorpus &corpus, const Params &params,
+                      float cornerTolerance, uint repeat) {
+    auto makeFinder = [&params](const GF::Img_t &mask) {
+        return std::make_unique<GF>(mask, params);
+    };
+    std::vector<FrameEvaluation> frames =
+        evaluateCorpus<GF>(corpus, cornerTolerance, makeFinder);
+    for (uint r = 1; r < repeat; ++r) {
+        std::vector<FrameEvaluation> again =
+            evaluateCorpus<GF>(corpus, cornerTolerance, makeFinder);
+        for (size_t i = 0; i < frames.size(); ++i)
+            frames[i].latency = std::min(frames[i].latency, again[i].latency);
+    }
+    Trial trial = {params, summarize(frames)};
+    for (const FrameEvaluation &f : frames)
+        trial.meanLatency += f.latency;
+    if (!frames.empty())
+        trial.meanLatency /= frames.size();
+    return trial;
+}
+
+static void printTrial(const char *label, const Trial &trial) {
+    std::cout << std::left << std::setw(40) << label << std::right
+              << " detection " << std::setw(6) << std::setprecision(4)
+              << trial.summary.detectionRate << "  latency "
+              << std::setw(8) << std::setprecision(5) << trial.meanLatency
+              << " µs\n";
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc < 3 || argc % 2 != 1) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <corpus.gfmc> <profile.txt> [options]\n";
+        return 1;
+    }
+    double minDetectionRate = -1;
+    float cornerTolerance   = 10;
+    uint repeat             = 3;
+    uint passes             = 3;
+    Params start            = {};
+    try {
+        for (int i = 3; i < argc; i += 2) {
+            std::string option = argv[i];
+            const char *value  = argv[i + 1];
+            if (option == "--min-detection-rate")
+                minDetectionRate = std::stod(value);
+            else if (option == "--corner-tolerance")
+                cornerTolerance = std::stof(value);
+            else if (option == "--repeat")
+                repeat = std::max(std::stoul(value), 1ul);
+            else if (option == "--passes")
+                passes = std::stoul(value);
+            else if (option == "--start") {
+                std::ifstream file(value);
+                if (!file)
+                    throw std::runtime_error(std::string("Error: unable to "
+                                                         "open ") +
+                                             value);
+                start = readParameters<W, H>(file);
+            } else
+                throw std::runtime_error("Error: unknown option " + option);
+        }
+        GF::checkParameters(start);
+    } catch (std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    MaskCorpus corpus = MaskCorpus(argv[1]);
+    Trial best        = evaluate(corpus, start, cornerTolerance, repeat);
+    printTrial("start", best);
+    if (minDetectionRate < 0)
+        minDetectionRate = best.summary.detectionRate;
+    if (best.summary.detectionRate < minDetectionRate) {
+        std::cerr << "Warning: the start parameters don't reach the minimum "
+                     "detection rate\n";
+        best.meanLatency = std::numeric_limits<double>::infinity();
+    }
+
+    for (uint pass = 0; pass < passes; ++pass) {
+        bool improved = false;
+        for (const Dimension &dim : dimensions) {
+            for (uint value : dim.values) {
+                if (value == best.params.*dim.member)
+                    continue;
+                Params candidate       = best.params;
+                candidate.*dim.member = value;
+                try {
+                    GF::checkParameters(candidate);
+                } catch (std::invalid_argument &) {
+                    continue;
+                }
+                Trial trial = evaluate(corpus, candidate, cornerTolerance,
+                                       repeat);
+                std::string label =
+                    std::string(dim.name) + " = " + std::to_string(value);
+                printTrial(label.c_str(), trial);
+                if (trial.summary.detectionRate >= minDetectionRate &&
+                    trial.meanLatency < best.meanLatency) {
+                    best     = trial;
+                    improved = true;
+                }
+            }
+        }
+        if (!improved)
+            break;
+    }
+
+    std::cout << "\nBest parameters:\n" << best.params;
+    printTrial("best", best);
+
+    std::ofstream profile(argv[2]);
+    profile << best.params;
+    if (!profile) {
+        std::cerr << "Error: unable to write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * Benchmark of the embedded build profile (see Config.hpp).
+ *
+ * The `embedded-benchmark` target is compiled with `GRID_FINDER_EMBEDDED=1`,
+ * `-fno-exceptions` and `-fno-rtti`, like the firmware of a flight controller
+ * would be: no exceptions, no iostreams and no heap allocations. It draws a
+ * synthetic grid on the mask, searches it repeatedly, and prints the status
+ * of the search, the corners of the square and the mean time per frame.
+ *
+ * The `embedded-benchmark-default` target is the same benchmark with the
+ * default profile, for comparison. `Scripts/Embedded-Report.sh` runs both
+ * and reports their code sizes.
+ *
+ * Usage: embedded-benchmark [frames]
+ */
+
+#include <GridFinder.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+constexpr size_t W = 410;
+constexpr size_t H = 308;
+using GF           = GridFinder<W, H>;
+
+/// Statically allocated: too large for the stack of a microcontroller, and
+/// there is no heap.
+static GF gf;
+
+/// Draw two families of parallel lines of the given width, rotated by the
+/// given angle, through the center of the mask.
+static void drawGrid(angle_t angle, int spacing, int width) {
+    const Pixel center = gf.center();
+    for (angle_t direction : {angle, angle.perpendicular()}) {
+        const angle_t normal = direction.perpendicular();
+        for (int offset = -2 * spacing; offset <= 2 * spacing;
+             offset += spacing) {
+            for (int i = -width / 2; i < width - width / 2; ++i) {
+                const int d = offset + spacing / 2 + i;
+                Pixel start = {
+                    uint(std::lround(center.x + d * normal.cosd())),
+                    uint(std::lround(center.y + d * normal.sind())),
+                };
+                if (!start.inRange(W, H))
+                    continue;
+                gf.drawLine(start, direction);
+                gf.drawLine(start, direction.opposite());
+            }
+        }
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    const unsigned long frames =
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+
+    drawGrid(angle_t(0.2), 150, 9);
+
+    using Clock = std::chrono::steady_clock;
+    Square sq;
+    auto start = Clock::now();
+    for (unsigned long i = 0; i < frames; ++i)
+        sq = gf.findSquare();
+    auto duration = Clock::now() - start;
+    double us = std::chrono::duration<double, std::micro>(duration).count();
+
+    std::printf("Profile:     %s\n",
+                GRID_FINDER_EMBEDDED ? "embedded" : "default");
+    std::printf("Status:      %s\n", toString(sq.status));
+    std::printf("Square:     ");
+    for (const auto &p : sq.points) {
+        if (p)
+            std::printf(" (%.3f, %.3f)", p->x, p->y);
+        else
+            std::printf(" -");
+    }
+    std::printf("\n");
+    std::printf("Steps:       %zu\n", gf.getStepCount());
+    std::printf("Object size: %zu bytes\n", sizeof(GF));
+    std::printf("Time:        %.2f µs/frame\n", us / frames);
+    return sq.status == SearchStatus::Ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,71 @@
+/**
+ * Benchmark of the Hough ray walks on large masks.
+ *
+ * Follows rays at different angles through a white 1920×1080 mask, starting
+ * with a cold cache, and prints the mean time per step for each angle. Rows
+ * of the mask are 1920 bytes apart, so rays that are close to vertical touch
+ * a new cache line on every step, and are much slower than horizontal rays
+ * without prefetching (see GridFinder::PREFETCH_DISTANCE).
+ *
+ * The `hough-benchmark-no-prefetch` target is the same benchmark with
+ * prefetching disabled, for comparison.
+ *
+ * Usage: hough-benchmark [rays per angle]
+ */
+
+#include <GridFinder.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr size_t W = 1920;
+constexpr size_t H = 1080;
+using GF           = GridFinder<W, H>;
+
+/// Larger than the last level cache, written to between rays to evict the
+/// mask from the cache.
+static std::vector<uint8_t> evictionBuffer(64 << 20);
+
+static void evictCache() {
+    for (size_t i = 0; i < evictionBuffer.size(); i += 64)
+        ++evictionBuffer[i];
+}
+
+int main(int argc, const char *argv[]) {
+    const uint rays = argc > 1 ? std::stoul(argv[1]) : 64;
+
+    auto mask = std::make_unique<TMatrix<uint8_t, H, W>>();
+    for (auto &row : *mask)
+        for (auto &px : row)
+            px = 0xFF;
+    auto gf = std::make_unique<GF>(*mask);
+
+    std::cout << "Prefetch distance: " << GF::PREFETCH_DISTANCE << "\n"
+              << "  angle    ns/step\n";
+    for (uint degrees = 0; degrees <= 90; degrees += 15) {
+        angle_t angle = degrees * M_PI / 180;
+        double nanoseconds = 0;
+        size_t steps       = 0;
+        for (uint i = 0; i < rays; ++i) {
+            // Spread the starting points over the top left quarter, so all
+            // rays are long, and no two rays are the same
+            Pixel start = {uint(i * W / 2 / rays),
+                           uint((i * 7 % rays) * H / 2 / rays)};
+            evictCache();
+            auto t0 = std::chrono::steady_clock::now();
+            HoughResult result = gf->hough(start, angle);
+            auto t1 = std::chrono::steady_clock::now();
+            nanoseconds += std::chrono::duration<double, std::nano>(t1 - t0)
+                               .count();
+            steps += result.count;
+        }
+        std::cout << std::setw(6) << degrees << "°  " << std::setw(9)
+                  << std::fixed << std::setprecision(2)
+                  << nanoseconds / steps << "\n";
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * Benchmark of the mask memory layouts (see MaskStorage.hpp).
+ *
+ * Draws synthetic 1920×1080 grids at different rotations, and prints the mean
+ * time of GridFinder::findSquare with a row-major mask and with a mask of 8×8
+ * tiles. The cache is evicted before every search, to simulate a new frame
+ * from the camera.
+ *
+ * Usage: layout-benchmark [repetitions]
+ */
+
+#include <GridFinder.hpp>
+#include <MaskStorage.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr size_t W = 1920;
+constexpr size_t H = 1080;
+using Img_t        = TMatrix<uint8_t, H, W>;
+using Params       = DefaultParameters<W, H>;
+using RowMajorGF   = GridFinder<W, H, Params, RowMajorStorage<W, H>>;
+using TiledGF      = GridFinder<W, H, Params, TiledStorage<W, H>>;
+
+/// Larger than the last level cache, written to before every search to evict
+/// the mask from the cache.
+static std::vector<uint8_t> evictionBuffer(64 << 20);
+
+static void evictCache() {
+    for (size_t i = 0; i < evictionBuffer.size(); i += 64)
+        ++evictionBuffer[i];
+}
+
+/// Draw a grid with the given rotation, 400 px cells and 25 px lines.
+static void drawGrid(Img_t &mask, double degrees) {
+    const double c = std::cos(degrees * M_PI / 180);
+    const double s = std::sin(degrees * M_PI / 180);
+    for (uint y = 0; y < H; ++y) {
+        for (uint x = 0; x < W; ++x) {
+            double u  = 4000 + x * c + y * s;
+            double v  = 4000 - x * s + y * c;
+            bool line = std::fmod(u, 400) < 25 || std::fmod(v, 400) < 25;
+            mask[y][x] = line ? 0xFF : 0x00;
+        }
+    }
+}
+
+/// Get the mean duration of findSquare in microseconds.
+template <class GF>
+static double benchmark(const Img_t &mask, uint repetitions) {
+    auto gf = std::make_unique<GF>(mask);
+    double microseconds = 0;
+    for (uint i = 0; i < repetitions; ++i) {
+        evictCache();
+        auto t0 = std::chrono::steady_clock::now();
+        gf->findSquare();
+        auto t1 = std::chrono::steady_clock::now();
+        microseconds +=
+            std::chrono::duration<double, std::micro>(t1 - t0).count();
+    }
+    return microseconds / repetitions;
+}
+
+int main(int argc, const char *argv[]) {
+    const uint repetitions = argc > 1 ? std::stoul(argv[1]) : 50;
+
+    auto mask = std::make_unique<Img_t>();
+    std::cout << " rotation   row-major [µs]   tiled [µs]\n"
+              << std::fixed << std::setprecision(1);
+    for (double degrees : {0., 10., 20., 30., 40.}) {
+        drawGrid(*mask, degrees);
+        double rowMajor = benchmark<RowMajorGF>(*mask, repetitions);
+        double tiled    = benchmark<TiledGF>(*mask, repetitions);
+        std::cout << std::setw(8) << degrees << "°  " << std::setw(15)
+                  << rowMajor << "  " << std::setw(11) << tiled << "\n";
+    }
+}
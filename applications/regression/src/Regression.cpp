@@ -0,0 +1,117 @@
+/**
+ * Accuracy and latency regression check.
+ *
+ * Runs GridFinder::findSquare on every frame of a labeled mask corpus (see
+ * MaskCorpus.hpp), and reports the detection rate, the corner error and the
+ * latency percentiles. When a baseline is given, the program fails if any of
+ * these metrics regressed beyond the tolerances.
+ *
+ * Usage: regression <corpus.gfmc> [options]
+ *
+ * Options:
+ *   --baseline <file>          Compare the results to this baseline.
+ *   --write-baseline <file>    Save the results as a new baseline.
+ *   --corner-tolerance <px>    Max. corner distance to count as detected (10).
+ *   --detection-tolerance <x>  Allowed absolute drop in detection rate (0.01).
+ *   --error-tolerance <px>     Allowed increase in mean corner error (0.25).
+ *   --max-error-tolerance <px> Allowed increase in max. corner error (1).
+ *   --latency-tolerance <x>    Allowed relative increase of p50/p99 (0.25).
+ *   --max-latency-tolerance <x> Allowed relative increase of max. latency (1).
+ *   --repeat <n>               Run the corpus n times, and keep the fastest
+ *                              latency of each frame, to reduce noise (3).
+ */
+
+#include <Evaluation.hpp>
+#include <GridFinder.hpp>
+#include <MaskCorpus.hpp>
+
+#include <algorithm>  // min, max
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/// The resolution of the masks (same as the Python module).
+constexpr size_t W = 410;
+constexpr size_t H = 308;
+using GF           = GridFinder<W, H>;
+
+int main(int argc, const char *argv[]) {
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: " << argv[0] << " <corpus.gfmc> [options]\n";
+        return 1;
+    }
+    std::string baselinePath, writeBaselinePath;
+    float cornerTolerance = 10;
+    uint repeat           = 3;
+    RegressionTolerances tolerances;
+    for (int i = 2; i < argc; i += 2) {
+        std::string option = argv[i];
+        const char *value  = argv[i + 1];
+        if (option == "--baseline")
+            baselinePath = value;
+        else if (option == "--write-baseline")
+            writeBaselinePath = value;
+        else if (option == "--corner-tolerance")
+            cornerTolerance = std::stof(value);
+        else if (option == "--detection-tolerance")
+            tolerances.detectionRate = std::stod(value);
+        else if (option == "--error-tolerance")
+            tolerances.meanCornerError = std::stod(value);
+        else if (option == "--max-error-tolerance")
+            tolerances.maxCornerError = std::stod(value);
+        else if (option == "--latency-tolerance")
+            tolerances.latency = std::stod(value);
+        else if (option == "--max-latency-tolerance")
+            tolerances.latencyMax = std::stod(value);
+        else if (option == "--repeat")
+            repeat = std::max(std::stoul(value), 1ul);
+        else {
+            std::cerr << "Error: unknown option " << option << "\n";
+            return 1;
+        }
+    }
+
+    MaskCorpus corpus = MaskCorpus(argv[1]);
+    std::vector<FrameEvaluation> frames =
+        evaluateCorpus<GF>(corpus, cornerTolerance);
+    for (uint r = 1; r < repeat; ++r) {
+        std::vector<FrameEvaluation> again =
+            evaluateCorpus<GF>(corpus, cornerTolerance);
+        for (size_t i = 0; i < frames.size(); ++i)
+            frames[i].latency = std::min(frames[i].latency, again[i].latency);
+    }
+    EvaluationSummary summary = summarize(frames);
+
+    std::cout << summary;
+    if (!summary.missedFrames.empty()) {
+        std::cout << "missed_frames =";
+        for (size_t frame : summary.missedFrames)
+            std::cout << ' ' << frame;
+        std::cout << "\n";
+    }
+
+    if (!writeBaselinePath.empty()) {
+        std::ofstream file(writeBaselinePath);
+        file << summary;
+        if (!file) {
+            std::cerr << "Error: unable to write " << writeBaselinePath << "\n";
+            return 1;
+        }
+    }
+
+    if (!baselinePath.empty()) {
+        std::ifstream file(baselinePath);
+        if (!file) {
+            std::cerr << "Error: unable to open " << baselinePath << "\n";
+            return 1;
+        }
+        EvaluationSummary baseline = readEvaluationSummary(file);
+        std::vector<std::string> regressions =
+            findRegressions(baseline, summary, tolerances);
+        for (const std::string &r : regressions)
+            std::cerr << "Regression: " << r << "\n";
+        if (!regressions.empty())
+            return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * Offline replay of recorded flights.
+ *
+ * Reads all binary PGM masks (or raw PPM camera frames, which are converted
+ * to masks first) in a directory, runs GridFinder::findSquare on each frame on
+ * a work-stealing thread pool, and writes the resulting squares and timings to
+ * a CSV file.
+ *
+ * Usage: replay <input-directory> <output.csv> [--threads N]
+ *
+ * Frames are processed in lexicographical order of their file names, and are
+ * numbered starting from 1, just like in `Python/VideoLines.py`, so the frame
+ * numbers match the ones in `Problematic-Lines.md`.
+ */
+
+#include <GridFinder.hpp>
+#include <PNM.hpp>
+#include <ThreadPool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock  = std::chrono::steady_clock;
+
+/// The resolution of the masks (same as the Python module).
+constexpr size_t W = 410;
+constexpr size_t H = 308;
+using GF           = GridFinder<W, H>;
+
+struct FrameResult {
+    Square square;
+    double loadTime = 0;  ///< µs
+    double findTime = 0;  ///< µs
+    std::string error;
+};
+
+static double microseconds(Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+static FrameResult processFrame(const fs::path &path) {
+    // One mask and one finder per worker thread, reused for all of its frames
+    thread_local auto mask = std::make_unique<GF::Img_t>();
+    thread_local auto gf   = std::make_unique<GF>();
+    FrameResult result;
+    try {
+        auto start = Clock::now();
+        toMask(readPNM(path.string()), *mask);
+        gf->setMask(*mask);
+        auto found = Clock::now();
+        result.square   = gf->findSquare();
+        auto end        = Clock::now();
+        result.loadTime = microseconds(found - start);
+        result.findTime = microseconds(end - found);
+    } catch (std::exception &e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+/// Quote a text field of the CSV file, doubling any embedded quotes.
+static std::string quoted(const std::string &text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"')
+            result += '"';
+        result += c;
+    }
+    return result + '"';
+}
+
+static void writeCSV(std::ostream &os, const std::vector<fs::path> &files,
+                     const std::vector<FrameResult> &results) {
+    os << "frame,file,lines,status,p0_x,p0_y,p1_x,p1_y,p2_x,p2_y,p3_x,p3_y,"
+          "load_us,find_us,error\n";
+    os << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const FrameResult &r = results[i];
+        uint lines           = std::count_if(r.square.lines.begin(),
+                                   r.square.lines.end(),
+                                   [](const auto &l) { return l.has_value(); });
+        // Frames that couldn't be loaded weren't searched, so they have no
+        // status
+        os << i + 1 << ',' << quoted(files[i].filename().string()) << ','
+           << lines << ','
+           << quoted(r.error.empty() ? toString(r.square.status) : "");
+        for (const std::optional<Point> &p : r.square.points) {
+            if (p)
+                os << ',' << p->x << ',' << p->y;
+            else
+                os << ",,";
+        }
+        os << ',' << r.loadTime << ',' << r.findTime << ','
+           << quoted(r.error) << '\n';
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc != 3 && !(argc == 5 && std::string(argv[3]) == "--threads")) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <input-directory> <output.csv> [--threads N]\n";
+        return 1;
+    }
+    uint numThreads = argc == 5 ? std::stoul(argv[4])  //
+                                : ThreadPool::defaultNumThreads();
+
+    std::vector<fs::path> files;
+    for (const fs::directory_entry &entry : fs::directory_iterator(argv[1]))
+        if (entry.path().extension() == ".pgm" ||
+            entry.path().extension() == ".ppm")
+            files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        std::cerr << "Error: no PGM or PPM files in " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<FrameResult> results(files.size());
+    auto start = Clock::now();
+    {
+        ThreadPool pool = ThreadPool(numThreads);
+        for (size_t i = 0; i < files.size(); ++i)
+            pool.submit([&, i] { results[i] = processFrame(files[i]); });
+        pool.wait();
+    }
+    double wallTime = microseconds(Clock::now() - start);
+
+    std::ofstream csv(argv[2]);
+    if (!csv) {
+        std::cerr << "Error: unable to open " << argv[2] << "\n";
+        return 1;
+    }
+    writeCSV(csv, files, results);
+
+    double findTime = 0;
+    size_t errors   = 0;
+    for (const FrameResult &r : results) {
+        findTime += r.findTime;
+        errors += !r.error.empty();
+    }
+    std::cout << "  Frames         : " << files.size() << " (" << errors
+              << " errors)\n"
+              << "  Threads        : " << numThreads << "\n"
+              << "  Wall time      : " << wallTime / 1e6 << " s\n"
+              << "  Throughput     : " << files.size() / (wallTime / 1e6)
+              << " fps\n"
+              << "  findSquare     : " << findTime / files.size()
+              << " µs/frame (mean)\n";
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <GridFinder.hpp>
+#include <MaskCorpus.hpp>
+#include <algorithm>  // sort, min
+#include <chrono>
+#include <cmath>  // hypot, ceil
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Tools for evaluating the accuracy and the latency of GridFinder::findSquare
+ * on a labeled corpus of masks (see MaskCorpus.hpp).
+ */
+
+/// The result of running GridFinder::findSquare on a single labeled frame.
+struct FrameEvaluation {
+    /// Whether all visible ground truth corners were found.
+    bool detected = false;
+    /// Whether a complete square was found in a frame without ground truth.
+    bool falsePositive = false;
+    /// Whether the frame has any visible ground truth corners.
+    bool labeled = false;
+    /// The errors of the matched corners in pixels.
+    std::vector<float> cornerErrors;
+    /// The time it took to find the square in microseconds.
+    double latency = 0;
+};
+
+/// The accuracy and latency statistics over a corpus.
+struct EvaluationSummary {
+    size_t frames          = 0;
+    size_t labeledFrames   = 0;
+    double detectionRate   = 0;  ///< Fraction of labeled frames detected
+    size_t falsePositives  = 0;
+    double meanCornerError = 0;  ///< px
+    double maxCornerError  = 0;  ///< px
+    double latencyP50      = 0;  ///< µs
+    double latencyP99      = 0;  ///< µs
+    double latencyMax      = 0;  ///< µs
+    /// The (1-based) numbers of the labeled frames that were not detected.
+    std::vector<size_t> missedFrames;
+};
+
+/**
+ * @brief   Get the @p p-th percentile of the given values, using the nearest
+ *          rank method.
+ * @param   values
+ *          The values, will be sorted in-place.
+ * @param   p
+ *          The percentile, between 0 and 100.
+ */
+inline double percentile(std::vector<double> &values, double p) {
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = std::ceil(p / 100 * values.size());
+    return values[rank == 0 ? 0 : std::min(rank, values.size()) - 1];
+}
+
+/**
+ * @brief   Compare a square to the ground truth. Every visible ground truth
+ *          corner is matched to the closest corner of the square.
+ *
+ * @param   square
+ *          The square found by GridFinder::findSquare.
+ * @param   gt
+ *          The ground truth corners.
+ * @param   tolerance
+ *          The maximum distance between a ground truth corner and the closest
+ *          corner of the square for the corner to be considered detected.
+ */
+inline FrameEvaluation evaluateSquare(const Square &square,
+                                      const GroundTruth &gt, float tolerance) {
+    FrameEvaluation result;
+    result.detected = true;
+    for (const std::optional<Point> &expected : gt) {
+        if (!expected)
+            continue;
+        result.labeled = true;
+        float error    = std::numeric_limits<float>::infinity();
+        for (const std::optional<Point> &found : square.points)
+            if (found)
+                error = std::min(error, std::hypot(found->x - expected->x,
+                                                   found->y - expected->y));
+        if (error > tolerance)
+            result.detected = false;
+        else
+            result.cornerErrors.push_back(error);
+    }
+    if (!result.labeled) {
+        result.detected      = false;
+        result.falsePositive = std::all_of(
+            square.points.begin(), square.points.end(),
+            [](const std::optional<Point> &p) { return p.has_value(); });
+    }
+    return result;
+}
+
+/// Combine the evaluations of all frames of a corpus.
+inline EvaluationSummary summarize(const std::vector<FrameEvaluation> &frames) {
+    EvaluationSummary summary;
+    summary.frames = frames.size();
+    std::vector<double> latencies;
+    latencies.reserve(frames.size());
+    size_t detected = 0;
+    size_t corners  = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const FrameEvaluation &f = frames[i];
+        latencies.push_back(f.latency);
+        summary.falsePositives += f.falsePositive;
+        if (!f.labeled)
+            continue;
+        ++summary.labeledFrames;
+        if (f.detected)
+            ++detected;
+        else
+            summary.missedFrames.push_back(i + 1);
+        for (float e : f.cornerErrors) {
+            summary.meanCornerError += e;
+            summary.maxCornerError = std::max<double>(summary.maxCornerError, e);
+            ++corners;
+        }
+    }
+    if (summary.labeledFrames > 0)
+        summary.detectionRate = double(detected) / summary.labeledFrames;
+    if (corners > 0)
+        summary.meanCornerError /= corners;
+    summary.latencyP50 = percentile(latencies, 50);
+    summary.latencyP99 = percentile(latencies, 99);
+    summary.latencyMax = percentile(latencies, 100);
+    return summary;
+}
+
+/**
+ * @brief   Run GridFinder::findSquare on every frame of the corpus and compare
+ *          the results to the ground truth.
+ *
+ * @tparam  GF
+ *          The type of GridFinder to use. The size of its masks must match
+ *          the size of the masks in the corpus.
+ * @param   corpus
+ *          The labeled corpus.
+ * @param   tolerance
+ *          See #evaluateSquare.
+ * @param   makeFinder
+ *          Function that returns a `std::unique_ptr<GF>` for the given mask.
+ *          This allows the caller to configure the finder before each frame.
+ *
+ * @throws  std::runtime_error
+ *          If the corpus has no ground truth, or if the size of the masks
+ *          doesn't match.
+ */
+template <class GF, class MakeFinder>
+std::vector<FrameEvaluation> evaluateCorpus(const MaskCorpus &corpus,
+                                            float tolerance,
+                                            MakeFinder makeFinder) {
+    using Clock = std::chrono::steady_clock;
+    if (!corpus.hasGroundTruth())
+        throw std::runtime_error("Error: corpus has no ground truth");
+    auto mask = std::make_unique<typename GF::Img_t>();
+    std::vector<FrameEvaluation> results;
+    results.reserve(corpus.size());
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        corpus[i].unpack(*mask);
+        std::unique_ptr<GF> gf = makeFinder(*mask);
+        auto start             = Clock::now();
+        Square square          = gf->findSquare();
+        auto end               = Clock::now();
+        results.push_back(evaluateSquare(square, corpus.groundTruth(i), //
+                                         tolerance));
+        results.back().latency =
+            std::chrono::duration<double, std::micro>(end - start).count();
+    }
+    return results;
+}
+
+/// @copydoc evaluateCorpus
+template <class GF>
+std::vector<FrameEvaluation> evaluateCorpus(const MaskCorpus &corpus,
+                                            float tolerance) {
+    return evaluateCorpus<GF>(corpus, tolerance, [](const auto &mask) {
+        return std::make_unique<GF>(mask);
+    });
+}
+
+/// Print the summary in the `key = value` format used for baselines.
+inline std::ostream &operator<<(std::ostream &os, const EvaluationSummary &s) {
+    os << "frames = " << s.frames << "\n"
+       << "labeled_frames = " << s.labeledFrames << "\n"
+       << "detection_rate = " << s.detectionRate << "\n"
+       << "false_positives = " << s.falsePositives << "\n"
+       << "mean_corner_error = " << s.meanCornerError << "\n"
+       << "max_corner_error = " << s.maxCornerError << "\n"
+       << "latency_p50 = " << s.latencyP50 << "\n"
+       << "latency_p99 = " << s.latencyP99 << "\n"
+       << "latency_max = " << s.latencyMax << "\n";
+    return os;
+}
+
+/**
+ * @brief   Read a summary that was written using
+ *          operator<<(std::ostream &, const EvaluationSummary &).
+ *          Unknown keys are ignored, missing keys keep their default value.
+ */
+inline EvaluationSummary readEvaluationSummary(std::istream &is) {
+    EvaluationSummary s;
+    std::string key, equals;
+    double value;
+    while (is >> key >> equals >> value) {
+        if (key == "frames")
+            s.frames = value;
+        else if (key == "labeled_frames")
+            s.labeledFrames = value;
+        else if (key == "detection_rate")
+            s.detectionRate = value;
+        else if (key == "false_positives")
+            s.falsePositives = value;
+        else if (key == "mean_corner_error")
+            s.meanCornerError = value;
+        else if (key == "max_corner_error")
+            s.maxCornerError = value;
+        else if (key == "latency_p50")
+            s.latencyP50 = value;
+        else if (key == "latency_p99")
+            s.latencyP99 = value;
+        else if (key == "latency_max")
+            s.latencyMax = value;
+    }
+    return s;
+}
+
+/// How much worse than the baseline a new evaluation is allowed to be.
+struct RegressionTolerances {
+    /// Absolute decrease of the detection rate.
+    double detectionRate = 0.01;
+    /// Absolute increase of the mean corner error in pixels.
+    double meanCornerError = 0.25;
+    /// Absolute increase of the maximum corner error in pixels. A single
+    /// frame with a bad corner barely moves the mean, but it does show up
+    /// here.
+    double maxCornerError = 1.0;
+    /// Relative increase of the latency percentiles (p50, p99).
+    double latency = 0.25;
+    /// Relative increase of the maximum latency (noisier than percentiles).
+    double latencyMax = 1.0;
+};
+
+/**
+ * @brief   Compare an evaluation to a baseline, and return a description of
+ *          every metric that regressed beyond the given tolerances.
+ *          Returns an empty vector if there are no regressions.
+ */
+inline std::vector<std::string>
+findRegressions(const EvaluationSummary &baseline,
+                const EvaluationSummary &current,
+                const RegressionTolerances &tol = {}) {
+    std::vector<std::string> regressions;
+    auto check = [&](const char *name, double base, double cur, double max) {
+        if (cur > max)
+            regressions.push_back(std::string(name) + ": " +
+                                  std::to_string(cur) + " (baseline " +
+                                  std::to_string(base) + ")");
+    };
+    auto checkRelative = [&](const char *name, double base, double cur,
+                             double tolerance) {
+        check(name, base, cur, base * (1 + tolerance));
+    };
+    if (current.detectionRate < baseline.detectionRate - tol.detectionRate)
+        regressions.push_back(
+            "detection_rate: " + std::to_string(current.detectionRate) +
+            " (baseline " + std::to_string(baseline.detectionRate) + ")");
+    check("false_positives", baseline.falsePositives, current.falsePositives,
+          baseline.falsePositives);
+    check("mean_corner_error", baseline.meanCornerError,
+          current.meanCornerError,
+          baseline.meanCornerError + tol.meanCornerError);
+    check("max_corner_error", baseline.maxCornerError, current.maxCornerError,
+          baseline.maxCornerError + tol.maxCornerError);
+    checkRelative("latency_p50", baseline.latencyP50, current.latencyP50,
+                  tol.latency);
+    checkRelative("latency_p99", baseline.latencyP99, current.latencyP99,
+                  tol.latency);
+    checkRelative("latency_max", baseline.latencyMax, current.latencyMax,
+                  tol.latencyMax);
+    return regressions;
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <Line.hpp>  // Point
+#include <Matrix.hpp>
+#include <Pixel.hpp>  // Rect
+#include <algorithm>  // fill
+#include <array>
+#include <cmath>  // NAN, isnan
+#include <cstdint>
+#include <cstdio>
+#include <cstring>  // memcmp
+#include <memory>  // unique_ptr
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <uint.hpp>
+#include <vector>
+
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+/**
+ * @file
+ *
+ * A compact binary container for many masks of the same size.
+ *
+ * ### File format
+ *
+ * All numbers are stored in the native byte order of the machine that wrote
+ * the file (little-endian on all supported platforms).
+ *
+ * | Offset | Contents                                                       |
+ * |--------|----------------------------------------------------------------|
+ * | 0      | Header (#MaskCorpusHeader, 24 bytes)                           |
+ * | 24     | `count` masks, each #MaskCorpusHeader::frameSize() bytes       |
+ * | ...    | Optional ground truth: `count` × 4 corners × (x, y) as `float` |
+ *
+ * Each mask is bit-packed in row-major order: pixel (x, y) is bit
+ * `(y * width + x) % 8` (LSB first) of byte `(y * width + x) / 8`. Masks are
+ * padded to a multiple of 8 bytes.
+ * Corners of the ground truth that are not visible in a frame are NaN.
+ * The order of the corners is the same as in Square::points.
+ */
+
+/// The ground truth corners of the square in one frame.
+using GroundTruth = std::array<std::optional<Point>, 4>;
+
+struct MaskCorpusHeader {
+    char magic[4]     = {'G', 'F', 'M', 'C'};
+    uint32_t version  = 1;
+    uint32_t width    = 0;
+    uint32_t height   = 0;
+    uint32_t count    = 0;
+    uint32_t flags    = 0;
+
+    /// Flag that indicates that the file contains ground truth squares.
+    constexpr static uint32_t HAS_GROUND_TRUTH = 1 << 0;
+
+    bool hasGroundTruth() const { return flags & HAS_GROUND_TRUTH; }
+
+    /// The size of one bit-packed mask in bytes.
+    size_t frameSize() const {
+        size_t bytes = (size_t(width) * height + 7) / 8;
+        return (bytes + 7) / 8 * 8;
+    }
+};
+
+static_assert(sizeof(MaskCorpusHeader) == 24);
+
+/**
+ * @brief   A read-only view of a bit-packed mask.
+ */
+class PackedMask {
+  public:
+    PackedMask(const uint8_t *bits, uint width, uint height)
+        : bits(bits), w(width), h(height) {}
+
+    uint width() const { return w; }
+    uint height() const { return h; }
+
+    /// Get the value of the given pixel (0x00 or 0xFF).
+    uint8_t get(uint x, uint y) const {
+        size_t index = size_t(y) * w + x;
+        return (bits[index / 8] >> (index % 8)) & 1 ? 0xFF : 0x00;
+    }
+
+    /**
+     * @brief   Unpack the mask to one byte per pixel.
+     *
+     * @throws  std::runtime_error
+     *          If the size of the mask doesn't match the size of the matrix.
+     */
+    template <size_t H, size_t W>
+    void unpack(TMatrix<uint8_t, H, W> &mask) const {
+        if (w != W || h != H)
+            throw std::runtime_error("Error: mask size doesn't match");
+        size_t index = 0;
+        for (uint y = 0; y < H; ++y)
+            for (uint x = 0; x < W; ++x, ++index)
+                mask[y][x] = (bits[index / 8] >> (index % 8)) & 1 ? 0xFF //
+                                                                  : 0x00;
+    }
+
+    /**
+     * @brief   Unpack only the pixels inside of the given region, e.g. the
+     *          region of interest of a GridFinder. Pixels outside of the
+     *          region are set to black.
+     *
+     * @throws  std::runtime_error
+     *          If the size of the mask doesn't match the size of the matrix.
+     */
+    template <size_t H, size_t W>
+    void unpack(TMatrix<uint8_t, H, W> &mask, Rect region) const {
+        if (w != W || h != H)
+            throw std::runtime_error("Error: mask size doesn't match");
+        uint xEnd = std::min<uint>(region.x + region.width, W);
+        uint yEnd = std::min<uint>(region.y + region.height, H);
+        for (uint y = 0; y < H; ++y) {
+            bool inside = y >= region.y && y < yEnd;
+            for (uint x = 0; x < W; ++x)
+                mask[y][x] = inside && x >= region.x && x < xEnd ? get(x, y) //
+                                                                 : 0x00;
+        }
+    }
+
+    /// Get a pointer to the raw bits.
+    const uint8_t *data() const { return bits; }
+
+  private:
+    const uint8_t *bits;
+    uint w, h;
+};
+
+/**
+ * @brief   A memory-mapped mask corpus file. Masks are never copied, they are
+ *          read directly from the mapped file.
+ */
+class MaskCorpus {
+  public:
+    /**
+     * @brief   Open and map the given corpus file.
+     *
+     * @throws  std::runtime_error
+     *          If the file cannot be opened, or if it's not a valid corpus.
+     */
+    explicit MaskCorpus(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Error: unable to open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Error: unable to stat " + path);
+        }
+        mappedSize = st.st_size;
+        if (mappedSize >= sizeof(MaskCorpusHeader))
+            mapped = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED || mappedSize < sizeof(MaskCorpusHeader)) {
+            mapped = MAP_FAILED;
+            throw std::runtime_error("Error: unable to map " + path);
+        }
+        std::memcpy(&header, mapped, sizeof(header));
+        if (std::memcmp(header.magic, MaskCorpusHeader().magic, 4) != 0 ||
+            header.version != 1 || mappedSize < expectedFileSize()) {
+            ::munmap(mapped, mappedSize);
+            mapped = MAP_FAILED;
+            throw std::runtime_error("Error: invalid mask corpus " + path);
+        }
+    }
+
+    MaskCorpus(const MaskCorpus &) = delete;
+    MaskCorpus &operator=(const MaskCorpus &) = delete;
+
+    ~MaskCorpus() {
+        if (mapped != MAP_FAILED)
+            ::munmap(mapped, mappedSize);
+    }
+
+    uint width() const { return header.width; }
+    uint height() const { return header.height; }
+    size_t size() const { return header.count; }
+    bool hasGroundTruth() const { return header.hasGroundTruth(); }
+
+    /// Get the mask with the given index.
+    PackedMask operator[](size_t index) const {
+        return {frames() + index * header.frameSize(), width(), height()};
+    }
+
+    /// Get the ground truth square of the frame with the given index.
+    GroundTruth groundTruth(size_t index) const {
+        GroundTruth result;
+        if (!hasGroundTruth())
+            return result;
+        const uint8_t *gt =
+            frames() + header.count * header.frameSize() + index * 8 * 4;
+        for (uint i = 0; i < 4; ++i) {
+            Point p;
+            std::memcpy(&p.x, gt + 8 * i + 0, 4);
+            std::memcpy(&p.y, gt + 8 * i + 4, 4);
+            if (!std::isnan(p.x) && !std::isnan(p.y))
+                result[i] = p;
+        }
+        return result;
+    }
+
+    class Iterator {
+      public:
+        Iterator(const MaskCorpus &corpus, size_t index)
+            : corpus(corpus), index(index) {}
+        PackedMask operator*() const { return corpus[index]; }
+        Iterator &operator++() { return ++index, *this; }
+        bool operator!=(const Iterator &o) const { return index != o.index; }
+
+      private:
+        const MaskCorpus &corpus;
+        size_t index;
+    };
+
+    Iterator begin() const { return {*this, 0}; }
+    Iterator end() const { return {*this, size()}; }
+
+  private:
+    const uint8_t *frames() const {
+        return static_cast<const uint8_t *>(mapped) + sizeof(MaskCorpusHeader);
+    }
+
+    size_t expectedFileSize() const {
+        size_t size = sizeof(MaskCorpusHeader) + //
+                      size_t(header.count) * header.frameSize();
+        if (header.hasGroundTruth())
+            size += size_t(header.count) * 8 * 4;
+        return size;
+    }
+
+    void *mapped      = MAP_FAILED;
+    size_t mappedSize = 0;
+    MaskCorpusHeader header;
+};
+
+/**
+ * @brief   Writes masks to a new corpus file.
+ *
+ * Masks are written to the file immediately, the ground truth squares are
+ * kept in memory until the file is closed.
+ */
+class MaskCorpusWriter {
+  public:
+    /**
+     * @brief   Create a new corpus file.
+     *
+     * @throws  std::runtime_error
+     *          If the file cannot be created.
+     */
+    MaskCorpusWriter(const std::string &path, uint width, uint height,
+                     bool withGroundTruth = false) {
+        header.width  = width;
+        header.height = height;
+        header.flags  = withGroundTruth ? MaskCorpusHeader::HAS_GROUND_TRUTH //
+                                        : 0;
+        // If anything below throws, the file is closed when the member is
+        // destroyed
+        file.reset(std::fopen(path.c_str(), "wb"));
+        if (!file)
+            throw std::runtime_error("Error: unable to create " + path);
+        write(&header, sizeof(header));
+        packed.resize(header.frameSize());
+    }
+
+    MaskCorpusWriter(const MaskCorpusWriter &) = delete;
+    MaskCorpusWriter &operator=(const MaskCorpusWriter &) = delete;
+
+    ~MaskCorpusWriter() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    /**
+     * @brief   Append a mask, given as one byte per pixel in row-major order.
+     *          Every pixel that's not zero is white.
+     */
+    void append(const uint8_t *mask, const GroundTruth &gt = {}) {
+        append([mask, this](uint x, uint y) { //
+            return mask[size_t(y) * header.width + x];
+        }, gt);
+    }
+
+    /// @copydoc append(const uint8_t *, const GroundTruth &)
+    template <size_t H, size_t W>
+    void append(const TMatrix<uint8_t, H, W> &mask,
+                const GroundTruth &gt = {}) {
+        if (W != header.width || H != header.height)
+            throw std::runtime_error("Error: mask size doesn't match");
+        append([&mask](uint x, uint y) { return mask[y][x]; }, gt);
+    }
+
+    /// Write the ground truth and the final header, and close the file.
+    void close() {
+        if (!file)
+            return;
+        // Take ownership first, so the file is closed (and not written again
+        // by the destructor) even if one of the writes fails
+        File f  = std::move(file);
+        bool ok = writeTo(f.get(), groundTruth.data(),
+                          groundTruth.size() * sizeof(float)) &&
+                  std::fseek(f.get(), 0, SEEK_SET) == 0 &&
+                  writeTo(f.get(), &header, sizeof(header));
+        ok &= std::fclose(f.release()) == 0;
+        if (!ok)
+            throw std::runtime_error("Error: unable to write mask corpus");
+    }
+
+    size_t size() const { return header.count; }
+
+  private:
+    template <class GetPixel>
+    void append(GetPixel get, const GroundTruth &gt) {
+        if (!file)
+            throw std::runtime_error("Error: mask corpus already closed");
+        std::fill(packed.begin(), packed.end(), 0);
+        size_t index = 0;
+        for (uint y = 0; y < header.height; ++y)
+            for (uint x = 0; x < header.width; ++x, ++index)
+                packed[index / 8] |= (get(x, y) != 0) << (index % 8);
+        write(packed.data(), packed.size());
+        if (header.hasGroundTruth()) {
+            for (const std::optional<Point> &p : gt) {
+                groundTruth.push_back(p ? p->x : NAN);
+                groundTruth.push_back(p ? p->y : NAN);
+            }
+        }
+        ++header.count;
+    }
+
+    using File = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+    static bool writeTo(std::FILE *f, const void *data, size_t size) {
+        return size == 0 || std::fwrite(data, size, 1, f) == 1;
+    }
+
+    void write(const void *data, size_t size) {
+        if (!writeTo(file.get(), data, size))
+            throw std::runtime_error("Error: unable to write mask corpus");
+    }
+
+    File file = {nullptr, &std::fclose};
+    MaskCorpusHeader header;
+    std::vector<uint8_t> packed;
+    std::vector<float> groundTruth;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <Matrix.hpp>
+#include <RedMask.hpp>
+#include <cctype>  // isspace
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <uint.hpp>
+#include <vector>
+
+/**
+ * @brief   An 8-bit image read from a binary Netpbm file: either a grayscale
+ *          PGM (`P5`) or an RGB PPM (`P6`) image.
+ */
+struct PNMImage {
+    uint width    = 0;
+    uint height   = 0;
+    uint channels = 0;  ///< 1 for PGM, 3 for PPM
+    /// The pixel data, row by row, with the channels of a pixel interleaved.
+    std::vector<uint8_t> data;
+
+    uint8_t at(uint x, uint y, uint channel = 0) const {
+        return data[(y * width + x) * channels + channel];
+    }
+};
+
+namespace PNMDetail {
+
+/// Read the next whitespace-separated header field, skipping comments.
+inline uint readHeaderField(std::istream &is) {
+    int c = is.get();
+    while (is && (std::isspace(c) || c == '#')) {
+        if (c == '#')
+            while (is && c != '\n')
+                c = is.get();
+        c = is.get();
+    }
+    if (!is || !std::isdigit(c))
+        throw std::runtime_error("Error: invalid PNM header");
+    uint value = 0;
+    while (is && std::isdigit(c)) {
+        value = 10 * value + (c - '0');
+        c     = is.get();
+    }
+    // A single whitespace character separates the header from the data
+    if (!std::isspace(c))
+        throw std::runtime_error("Error: invalid PNM header");
+    return value;
+}
+
+}  // namespace PNMDetail
+
+/**
+ * @brief   Read a binary PGM (`P5`) or PPM (`P6`) image from the given stream.
+ *          Only 8-bit images are supported.
+ *
+ * @throws  std::runtime_error
+ *          If the stream doesn't contain a valid 8-bit PGM or PPM image.
+ */
+inline PNMImage readPNM(std::istream &is) {
+    char magic[2] = {};
+    is.read(magic, 2);
+    if (!is || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6'))
+        throw std::runtime_error("Error: not a binary PGM or PPM image");
+    PNMImage img;
+    img.channels = magic[1] == '5' ? 1 : 3;
+    img.width    = PNMDetail::readHeaderField(is);
+    img.height   = PNMDetail::readHeaderField(is);
+    uint maxval  = PNMDetail::readHeaderField(is);
+    if (maxval == 0 || maxval > 255)
+        throw std::runtime_error("Error: only 8-bit PNM images are supported");
+    img.data.resize(size_t(img.width) * img.height * img.channels);
+    is.read(reinterpret_cast<char *>(img.data.data()), img.data.size());
+    if (!is)
+        throw std::runtime_error("Error: unexpected end of PNM image data");
+    return img;
+}
+
+/// Read a binary PGM (`P5`) or PPM (`P6`) image from the given file.
+inline PNMImage readPNM(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Error: unable to open " + path);
+    return readPNM(file);
+}
+
+/// Write a mask to the given stream as a binary PGM (`P5`) image.
+template <size_t H, size_t W>
+std::ostream &writePGM(std::ostream &os, const TMatrix<uint8_t, H, W> &mask) {
+    os << "P5\n" << W << ' ' << H << "\n255\n";
+    for (const auto &row : mask)
+        for (uint8_t el : row)
+            os.put(el ? 0xFF : 0x00);
+    return os;
+}
+
+/**
+ * @brief   Convert an image to a mask.
+ *
+ *          Grayscale images are treated as pre-extracted masks: every pixel
+ *          that's not zero is white.
+ *          RGB images are treated as raw camera frames, and are converted
+ *          using #isRed, the same way `Python/VideoLines.py` does it.
+ *
+ * @throws  std::runtime_error
+ *          If the size of the image doesn't match the size of the mask.
+ */
+template <size_t H, size_t W>
+void toMask(const PNMImage &img, TMatrix<uint8_t, H, W> &mask) {
+    if (img.width != W || img.height != H)
+        throw std::runtime_error("Error: image size doesn't match mask size");
+    const uint8_t *px = img.data.data();
+    for (uint y = 0; y < H; ++y) {
+        for (uint x = 0; x < W; ++x) {
+            if (img.channels == 1)
+                mask[y][x] = *px ? 0xFF : 0x00;
+            else
+                mask[y][x] = isRed(px[0], px[1], px[2]) ? 0xFF : 0x00;
+            px += img.channels;
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <algorithm>  // min, max
+#include <cstdint>
+
+/**
+ * @brief   Check whether an RGB pixel is part of the red grid.
+ *
+ * This is the integer equivalent of the `redmask` function in
+ * `Python/VideoLines.py`, which converts the image to HSV using OpenCV and
+ * selects the hues in the range [0, 10] ∪ [170, 180] (i.e. within ±20° of pure
+ * red) with a saturation of at least 30/255. The brightness is not used.
+ */
+inline bool isRed(uint8_t r, uint8_t g, uint8_t b) {
+    int max  = std::max({r, g, b});
+    int min  = std::min({r, g, b});
+    int diff = max - min;
+    // Saturation = 255 × diff / max ≥ 29.5
+    if (diff == 0 || 2 * 255 * diff < 59 * max)
+        return false;
+    // OpenCV only uses the red sextant if red is the (first) maximum
+    if (r != max)
+        return false;
+    // Hue = 60° × (g - b) / diff, red if |hue| < 21°
+    int hueNumerator = g > b ? g - b : b - g;
+    return 20 * hueNumerator < 7 * diff;
+}
@@ -0,0 +1,86 @@
+#include <Evaluation.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(Evaluation, percentile) {
+    std::vector<double> values = {5, 1, 4, 2, 3, 6, 7, 8, 9, 10};
+    EXPECT_EQ(percentile(values, 50), 5);
+    EXPECT_EQ(percentile(values, 99), 10);
+    EXPECT_EQ(percentile(values, 100), 10);
+    EXPECT_EQ(percentile(values, 0), 1);
+}
+
+TEST(Evaluation, evaluateSquare) {
+    Square sq;
+    sq.points = {{Point{10, 10}, Point{20, 10}, Point{10, 20}, std::nullopt}};
+    GroundTruth gt = {{Point{21, 10}, Point{10, 12}, std::nullopt, Point{}}};
+    gt[3]          = std::nullopt;
+
+    FrameEvaluation result = evaluateSquare(sq, gt, 5);
+    EXPECT_TRUE(result.labeled);
+    EXPECT_TRUE(result.detected);
+    EXPECT_EQ(result.cornerErrors, std::vector<float>({1, 2}));
+
+    gt[3]  = Point{20, 20};
+    result = evaluateSquare(sq, gt, 5);
+    EXPECT_FALSE(result.detected);
+}
+
+TEST(Evaluation, summarize) {
+    std::vector<FrameEvaluation> frames(4);
+    frames[0] = {true, false, true, {1, 3}, 100};
+    frames[1] = {false, false, true, {}, 300};
+    frames[2] = {false, true, false, {}, 200};
+    frames[3] = {true, false, true, {2}, 400};
+
+    EvaluationSummary s = summarize(frames);
+    EXPECT_EQ(s.frames, 4);
+    EXPECT_EQ(s.labeledFrames, 3);
+    EXPECT_DOUBLE_EQ(s.detectionRate, 2. / 3);
+    EXPECT_EQ(s.falsePositives, 1);
+    EXPECT_DOUBLE_EQ(s.meanCornerError, 2);
+    EXPECT_DOUBLE_EQ(s.maxCornerError, 3);
+    EXPECT_EQ(s.latencyP50, 200);
+    EXPECT_EQ(s.latencyMax, 400);
+    EXPECT_EQ(s.missedFrames, std::vector<size_t>({2}));
+}
+
+TEST(Evaluation, baselineRoundTrip) {
+    EvaluationSummary s;
+    s.frames        = 10;
+    s.detectionRate = 0.75;
+    s.latencyP99    = 123.5;
+    std::stringstream ss;
+    ss << s;
+    EvaluationSummary result = readEvaluationSummary(ss);
+    EXPECT_EQ(result.frames, 10);
+    EXPECT_DOUBLE_EQ(result.detectionRate, 0.75);
+    EXPECT_DOUBLE_EQ(result.latencyP99, 123.5);
+}
+
+TEST(Evaluation, findRegressions) {
+    EvaluationSummary baseline;
+    baseline.detectionRate   = 0.9;
+    baseline.meanCornerError = 1;
+    baseline.maxCornerError  = 2;
+    baseline.latencyP50      = 100;
+    baseline.latencyP99      = 200;
+    baseline.latencyMax      = 300;
+
+    EvaluationSummary current = baseline;
+    EXPECT_TRUE(findRegressions(baseline, current).empty());
+
+    current.detectionRate = 0.85;
+    current.latencyP99    = 300;
+    EXPECT_EQ(findRegressions(baseline, current).size(), 2);
+
+    // A single corner that jumps by 20 px hardly changes the mean
+    current                = baseline;
+    current.maxCornerError = 20;
+    std::vector<std::string> regressions = findRegressions(baseline, current);
+    ASSERT_EQ(regressions.size(), 1);
+    EXPECT_EQ(regressions[0].rfind("max_corner_error", 0), 0);
+    RegressionTolerances tolerances;
+    tolerances.maxCornerError = 20;
+    EXPECT_TRUE(findRegressions(baseline, current, tolerances).empty());
+}
@@ -0,0 +1,120 @@
+#include <MaskCorpus.hpp>
+#include <gtest/gtest.h>
+#include <unistd.h>  // dup, close
+
+TEST(MaskCorpus, writeAndRead) {
+    std::string path = testing::TempDir() + "test-MaskCorpus.gfmc";
+    TMatrix<uint8_t, 3, 5> a = {{
+        {0x00, 0xFF, 0x00, 0x00, 0xFF},
+        {0x00, 0xFF, 0x00, 0x00, 0x00},
+        {0xFF, 0xFF, 0xFF, 0x00, 0x00},
+    }};
+    TMatrix<uint8_t, 3, 5> b = {{
+        {0xFF, 0x00, 0x00, 0x00, 0x00},
+        {0x00, 0x00, 0x00, 0x00, 0x00},
+        {0x00, 0x00, 0x00, 0x00, 0x01},
+    }};
+    GroundTruth gtA = {{Point{1, 2}, Point{3, 4}, std::nullopt, Point{5, 6}}};
+    {
+        MaskCorpusWriter writer = {path, 5, 3, true};
+        writer.append(a, gtA);
+        writer.append(b);
+        EXPECT_EQ(writer.size(), 2);
+    }
+
+    MaskCorpus corpus = MaskCorpus(path);
+    ASSERT_EQ(corpus.size(), 2);
+    EXPECT_EQ(corpus.width(), 5);
+    EXPECT_EQ(corpus.height(), 3);
+    ASSERT_TRUE(corpus.hasGroundTruth());
+
+    TMatrix<uint8_t, 3, 5> result;
+    corpus[0].unpack(result);
+    for (uint y = 0; y < 3; ++y)
+        for (uint x = 0; x < 5; ++x)
+            EXPECT_EQ(result[y][x], a[y][x]);
+    EXPECT_EQ(corpus[1].get(0, 0), 0xFF);
+    EXPECT_EQ(corpus[1].get(4, 2), 0xFF);
+    EXPECT_EQ(corpus[1].get(1, 0), 0x00);
+
+    EXPECT_EQ(corpus.groundTruth(0), gtA);
+    EXPECT_EQ(corpus.groundTruth(1), GroundTruth());
+
+    size_t count = 0;
+    for (PackedMask mask : corpus) {
+        EXPECT_EQ(mask.width(), 5);
+        ++count;
+    }
+    EXPECT_EQ(count, 2);
+}
+
+TEST(MaskCorpus, invalidFile) {
+    std::string path = testing::TempDir() + "test-MaskCorpus-invalid.gfmc";
+    std::FILE *f     = std::fopen(path.c_str(), "wb");
+    std::fputs("This is not a mask corpus.", f);
+    std::fclose(f);
+    EXPECT_THROW(MaskCorpus corpus(path), std::runtime_error);
+}
+
+TEST(MaskCorpus, sizeMismatch) {
+    std::string path = testing::TempDir() + "test-MaskCorpus-size.gfmc";
+    MaskCorpusWriter writer = {path, 5, 3};
+    TMatrix<uint8_t, 2, 2> mask = {};
+    EXPECT_THROW(writer.append(mask), std::runtime_error);
+}
+
+TEST(MaskCorpus, unpackRegion) {
+    std::string path = testing::TempDir() + "test-MaskCorpus-region.gfmc";
+    TMatrix<uint8_t, 3, 4> mask = {{
+        {0xFF, 0xFF, 0xFF, 0xFF},
+        {0xFF, 0xFF, 0xFF, 0xFF},
+        {0xFF, 0xFF, 0xFF, 0xFF},
+    }};
+    {
+        MaskCorpusWriter writer = {path, 4, 3};
+        writer.append(mask);
+    }
+    MaskCorpus corpus = MaskCorpus(path);
+    TMatrix<uint8_t, 3, 4> result;
+    corpus[0].unpack(result, Rect{1, 1, 2, 5});
+    TMatrix<uint8_t, 3, 4> expected = {{
+        {0x00, 0x00, 0x00, 0x00},
+        {0x00, 0xFF, 0xFF, 0x00},
+        {0x00, 0xFF, 0xFF, 0x00},
+    }};
+    for (uint y = 0; y < 3; ++y)
+        for (uint x = 0; x < 4; ++x)
+            EXPECT_EQ(result[y][x], expected[y][x]);
+}
+
+/// The lowest file descriptor that's not in use.
+static int lowestFreeDescriptor() {
+    int fd = ::dup(0);
+    ::close(fd);
+    return fd;
+}
+
+TEST(MaskCorpus, writerClosesFileOnError) {
+    std::string path = testing::TempDir() + "test-MaskCorpus-huge.gfmc";
+    int before       = lowestFreeDescriptor();
+    // The frame buffer is too large to allocate, after the file was opened
+    EXPECT_THROW(MaskCorpusWriter writer(path, 0xFFFFFFFF, 0xFFFFFFFF),
+                 std::bad_alloc);
+    EXPECT_EQ(lowestFreeDescriptor(), before);
+}
+
+TEST(MaskCorpus, writerClosesFileIfCloseFails) {
+    int before = lowestFreeDescriptor();
+    {
+        // Writes to /dev/full fail once the stdio buffer is flushed
+        MaskCorpusWriter writer = {"/dev/full", 5, 3, true};
+        TMatrix<uint8_t, 3, 5> mask = {};
+        for (uint i = 0; i < 200; ++i)  // 1.6 KB of masks, 6.4 KB ground truth
+            writer.append(mask, {{Point{1, 2}, Point{3, 4}}});
+        EXPECT_THROW(writer.close(), std::runtime_error);
+        EXPECT_EQ(lowestFreeDescriptor(), before);
+        // Nothing left to write or close
+        EXPECT_NO_THROW(writer.close());
+    }
+    EXPECT_EQ(lowestFreeDescriptor(), before);
+}
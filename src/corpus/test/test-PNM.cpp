@@ -0,0 +1,59 @@
+#include <PNM.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(PNM, readPGM) {
+    std::string header = "P5\n# comment\n3 2\n255\n";
+    std::istringstream is(header + std::string("\x00\x01\xFF\x00\x00\x10", 6));
+    PNMImage img = readPNM(is);
+    EXPECT_EQ(img.width, 3);
+    EXPECT_EQ(img.height, 2);
+    EXPECT_EQ(img.channels, 1);
+    EXPECT_EQ(img.at(2, 0), 0xFF);
+
+    TMatrix<uint8_t, 2, 3> mask;
+    toMask(img, mask);
+    TMatrix<uint8_t, 2, 3> expect = {{
+        {0x00, 0xFF, 0xFF},
+        {0x00, 0x00, 0xFF},
+    }};
+    for (uint y = 0; y < 2; ++y)
+        for (uint x = 0; x < 3; ++x)
+            EXPECT_EQ(mask[y][x], expect[y][x]);
+}
+
+TEST(PNM, readPPMRedMask) {
+    std::istringstream is("P6 2 1 255\n"
+                          "\xC0\x20\x28"   // red
+                          "\x20\xC0\x28");  // green
+    PNMImage img = readPNM(is);
+    TMatrix<uint8_t, 1, 2> mask;
+    toMask(img, mask);
+    EXPECT_EQ(mask[0][0], 0xFF);
+    EXPECT_EQ(mask[0][1], 0x00);
+}
+
+TEST(PNM, writeAndReadPGM) {
+    TMatrix<uint8_t, 2, 2> mask = {{
+        {0x00, 0xFF},
+        {0xFF, 0x00},
+    }};
+    std::stringstream s;
+    writePGM(s, mask);
+    TMatrix<uint8_t, 2, 2> result;
+    toMask(readPNM(s), result);
+    for (uint y = 0; y < 2; ++y)
+        for (uint x = 0; x < 2; ++x)
+            EXPECT_EQ(result[y][x], mask[y][x]);
+}
+
+TEST(PNM, invalid) {
+    std::istringstream is("P3\n2 2\n255\n");
+    EXPECT_THROW(readPNM(is), std::runtime_error);
+}
+
+TEST(PNM, sizeMismatch) {
+    std::istringstream is("P5 1 1 255\n\xFF");
+    TMatrix<uint8_t, 2, 2> mask;
+    EXPECT_THROW(toMask(readPNM(is), mask), std::runtime_error);
+}
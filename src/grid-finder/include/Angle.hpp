@@ -1,10 +1,13 @@
 #pragma once
 
+#include <Config.hpp>
 #include <array>
 #include <cmath>
 #include <limits>
-#include <ostream>
 #include <uint.hpp>
+#if GRID_FINDER_IOSTREAM
+#include <ostream>
+#endif
 
 template <uint>
 class Angle;
@@ -42,9 +45,11 @@ struct CosSin {
     [[nodiscard]] constexpr double rad() const { return std::atan2(sin, cos); }
 };
 
+#if GRID_FINDER_IOSTREAM
 inline std::ostream &operator<<(std::ostream &os, CosSin angle) {
     return os << angle.rad();
 }
+#endif
 
 template <uint Resolution>
 class Angle {
@@ -165,10 +170,12 @@ class Angle {
 
 using angle_t = Angle<360>;
 
+#if GRID_FINDER_IOSTREAM
 template <uint Resolution>
 std::ostream &operator<<(std::ostream &os, Angle<Resolution> angle) {
     return os << angle.deg() << "°";
 }
+#endif
 
 template <uint Resolution>
 constexpr bool operator==(Angle<Resolution> lhs, CosSin rhs) {
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <uint.hpp>
+
+/**
+ * @file
+ *
+ * Bit scan primitives for finding the first black or white pixel in a bit mask
+ * of pixel values, without testing the pixels one by one.
+ *
+ * The masks are built without branches (bit `i` is set if pixel `i` matches),
+ * and the first match is found with a single instruction on GCC and Clang.
+ * See GridFinder::probeWidth.
+ *
+ * @note    The line searches along a BresenhamLine still test the pixels one
+ *          by one: the Bresenham steps dominate their cost, and the branches
+ *          on the pixel values are predicted well because they only change at
+ *          the edges of the lines. Bit scans pay off when the pixel positions
+ *          come from a table, like the PerpendicularStencils of the width
+ *          probes.
+ */
+
+/// Get the index of the lowest set bit. The result is undefined if
+/// @p x is zero.
+inline uint countTrailingZeros(uint32_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    uint n = 0;
+    for (; (x & 1) == 0; x >>= 1)
+        ++n;
+    return n;
+#endif
+}
@@ -1,14 +1,25 @@
 #pragma once
 
 #include <Angle.hpp>
+#include <Config.hpp>
 #include <Pixel.hpp>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#if GRID_FINDER_EXCEPTIONS
+#include <stdexcept>
+#endif
+#if GRID_FINDER_EXCEPTIONS && GRID_FINDER_IOSTREAM
 #include <sstream>
+#endif
 
 class BresenhamLine {
   public:
     BresenhamLine(Pixel start, int cos, int sin, uint w, uint h)
+        : BresenhamLine(start, cos, sin, Rect{0, 0, w, h}) {}
+
+    /// Only draw the part of the line within the given region.
+    BresenhamLine(Pixel start, int cos, int sin, Rect bounds)
         : px0(start), px(start),  // Starting point
           dx(cos),
           dy(sin),  // cosine and sine of the slope of the line (scaled)
@@ -16,7 +27,7 @@ class BresenhamLine {
           ady(std::abs(dy)),             // absolute values of cos and sin
           xinc(sgn(dx)), yinc(sgn(dy)),  // increment steps for x and y
           steep(ady > adx),  // whether to increment x or y on each iteration
-          w(w), h(h) {       // size of the canvas
+          bounds(bounds) {   // region of the canvas to draw in
         if (steep)
             error = (adx - ady) / 2;
         else
@@ -29,16 +40,49 @@ class BresenhamLine {
     BresenhamLine(Pixel start, double angle, uint w, uint h)
         : BresenhamLine(start, cos(angle), sin(angle), w, h) {}
 
-    bool hasNext() const { return px.inRange(w, h); }
+    BresenhamLine(Pixel start, CosSin angle, Rect bounds)
+        : BresenhamLine(start, angle.cos, angle.sin, bounds) {}
+
+    bool hasNext() const { return bounds.contains(px); }
 
     uint getCurrentLength() const { return length; }
 
+    /// Get the pixel that will be returned by the next call to #next, without
+    /// advancing.
+    Pixel peek() const { return px; }
+
+    /// Get the offset from the current pixel to the pixel that's about
+    /// @p distance steps ahead. The components can be negative, they wrap
+    /// around, so they can be added to the coordinates of #peek.
+    Pixel getLookahead(uint distance) const {
+        int64_t major = steep ? ady : adx;
+        if (major == 0)
+            return {0, 0};
+        // Round to the nearest pixel
+        auto scale = [&](int64_t d) {
+            return uint((d * distance + sgn(d) * major / 2) / major);
+        };
+        return {scale(dx), scale(dy)};
+    }
+
+    /// Get the current pixel and advance to the next one.
+    /// @throws std::out_of_range
+    ///         If there is no next pixel. Without exceptions, the current
+    ///         pixel is returned without advancing, and nothing is reported:
+    ///         check #hasNext first (see GridFinder::nextPixel).
     Pixel next() {
         if (!hasNext()) {
+#if GRID_FINDER_EXCEPTIONS && GRID_FINDER_IOSTREAM
             std::ostringstream what;
             what << "Error: No more pixels on line withing canvas! Pixel = "
-                 << px << ", Size = " << Pixel(w, h);
+                 << px << ", Bounds = " << bounds;
             throw std::out_of_range(what.str());
+#elif GRID_FINDER_EXCEPTIONS
+            throw std::out_of_range(
+                "Error: No more pixels on line withing canvas!");
+#else
+            return px;
+#endif
         }
         Pixel result = px;
         if (steep) {
@@ -76,7 +120,7 @@ class BresenhamLine {
     int adx, ady;
     int xinc, yinc;
     bool steep;
-    uint w, h;
+    Rect bounds;
     int error;
     uint length = 0;
 
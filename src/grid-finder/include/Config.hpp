@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * @file
+ *
+ * Compile-time configuration of the parts of the standard library that the
+ * grid finder may use. The defaults are meant for desktop builds, define
+ * `GRID_FINDER_EMBEDDED=1` to build for a microcontroller.
+ */
+
+#ifndef GRID_FINDER_EMBEDDED
+/// Build for a microcontroller: no exceptions, no iostreams and no heap
+/// allocations. Errors are reported through Square::status instead.
+#define GRID_FINDER_EMBEDDED 0
+#endif
+
+#ifndef GRID_FINDER_EXCEPTIONS
+/// Report errors by throwing exceptions. If disabled, GridFinder reports them
+/// through Square::status. Disabled automatically when compiling with
+/// `-fno-exceptions`.
+#if GRID_FINDER_EMBEDDED ||                                                    \
+    !(defined(__cpp_exceptions) || defined(__EXCEPTIONS))
+#define GRID_FINDER_EXCEPTIONS 0
+#else
+#define GRID_FINDER_EXCEPTIONS 1
+#endif
+#endif
+
+#ifndef GRID_FINDER_IOSTREAM
+/// Include the printing functions and the warnings on `std::cerr`.
+#define GRID_FINDER_IOSTREAM (!GRID_FINDER_EMBEDDED)
+#endif
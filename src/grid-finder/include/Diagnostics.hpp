@@ -0,0 +1,139 @@
+#pragma once
+
+#include <Angle.hpp>
+#include <Pixel.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <uint.hpp>
+
+/**
+ * @file
+ *
+ * Diagnostics of the grid finder, without any I/O on the hot path.
+ *
+ * GridFinder records noteworthy events (a line candidate that was rejected, a
+ * maximum at the edge of the search range, an error ...) in a
+ * #DiagnosticsRing. Another thread, or the same thread between frames, can
+ * drain the ring at its own pace, e.g. to log the events.
+ */
+
+/// The kinds of events recorded by GridFinder.
+enum class DiagnosticEvent : uint8_t {
+    /// The maximum vote count of findLineAngleAccurateRange lies at the edge
+    /// of the range, so the actual maximum could lie outside of it.
+    /// Value: the maximum vote count.
+    MaximumAtRangeEdge,
+    /// getMiddleWithRetries fell off the canvas without finding the middle
+    /// of the line, or the search for the fourth line ran out of offsets.
+    /// Value: the number of attempts.
+    RetriesExhausted,
+    /// A line candidate was too narrow or too wide.
+    /// Value: the width of the candidate.
+    LineRejectedWidth,
+    /// A line candidate didn't get enough votes.
+    /// Value: the vote count of the candidate.
+    LineRejectedVotes,
+    /// The search failed. Value: the SearchStatus.
+    Error,
+    /// The frame was rejected by GridFinder::checkFrame before searching.
+    /// Value: the SearchStatus.
+    FrameRejected,
+};
+
+/// Get the name of the event, without the need for iostreams.
+constexpr const char *toString(DiagnosticEvent event) {
+    switch (event) {
+        case DiagnosticEvent::MaximumAtRangeEdge: return "MaximumAtRangeEdge";
+        case DiagnosticEvent::RetriesExhausted: return "RetriesExhausted";
+        case DiagnosticEvent::LineRejectedWidth: return "LineRejectedWidth";
+        case DiagnosticEvent::LineRejectedVotes: return "LineRejectedVotes";
+        case DiagnosticEvent::Error: return "Error";
+        case DiagnosticEvent::FrameRejected: return "FrameRejected";
+        default: return "Unknown";
+    }
+}
+
+/// A single diagnostic event, with the place where it happened.
+struct Diagnostic {
+    DiagnosticEvent event;
+    Pixel pixel;    ///< The pixel where the event occurred (if applicable).
+    angle_t angle;  ///< The angle of the line or ray (if applicable).
+    uint value;     ///< Meaning depends on the event, see DiagnosticEvent.
+};
+
+/**
+ * @brief   A lock-free single-producer, single-consumer ring buffer of
+ *          diagnostic events.
+ *
+ * The producer is the thread that runs the GridFinder that owns the ring, so
+ * every thread that runs its own GridFinder has its own ring, and the
+ * producers never contend with each other. The consumer can be any other
+ * single thread. When the ring is full, new events are dropped and counted,
+ * the producer never waits.
+ *
+ * @tparam  Capacity
+ *          The maximum number of events that are kept, must be a power of
+ *          two.
+ */
+template <size_t Capacity>
+class DiagnosticsRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+  public:
+    /**
+     * @brief   Add an event (producer only). Wait-free.
+     * @return  False if the ring was full and the event was dropped.
+     */
+    bool push(const Diagnostic &diagnostic) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[h % Capacity] = diagnostic;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief   Remove all events that are currently in the ring, and call
+     *          the given function for each of them, oldest first (consumer
+     *          only).
+     * @return  The number of events that were drained.
+     */
+    template <class F>
+    size_t drain(F &&f) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t h = head.load(std::memory_order_acquire);
+        for (size_t i = t; i != h; ++i)
+            f(static_cast<const Diagnostic &>(buffer[i % Capacity]));
+        tail.store(h, std::memory_order_release);
+        return h - t;
+    }
+
+    /// Get the number of events in the ring (approximate if the other thread
+    /// is pushing or draining at the same time).
+    size_t size() const {
+        return head.load(std::memory_order_acquire) -
+               tail.load(std::memory_order_acquire);
+    }
+
+    /// Get the total number of events that were dropped because the ring was
+    /// full.
+    size_t getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+  private:
+    /// Written by the producer only, on its own cache line.
+    alignas(64) std::atomic<size_t> head{0};
+    std::atomic<size_t> dropped{0};
+    /// Written by the consumer only.
+    alignas(64) std::atomic<size_t> tail{0};
+    std::array<Diagnostic, Capacity> buffer;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Angle.hpp>
+#include <Config.hpp>
+#include <Line.hpp>
+#include <Pixel.hpp>
+#include <cstdint>
+#include <optional>
+#include <uint.hpp>
+#if GRID_FINDER_IOSTREAM
+#include <ostream>
+#endif
+
+/// A point with fixed-point coordinates, with #FRACTION_BITS fractional bits.
+struct FixedPoint {
+    /// The number of fractional bits of the coordinates (1/256 pixel).
+    constexpr static uint FRACTION_BITS = 8;
+
+    int32_t x;
+    int32_t y;
+
+    /// Convert to floating point coordinates in pixels.
+    Point toPoint() const {
+        constexpr float scale = 1 << FRACTION_BITS;
+        return {x / scale, y / scale};
+    }
+
+    constexpr bool operator==(FixedPoint rhs) const {
+        return this->x == rhs.x && this->y == rhs.y;
+    }
+};
+
+#if GRID_FINDER_IOSTREAM
+inline std::ostream &operator<<(std::ostream &os, FixedPoint p) {
+    return os << p.toPoint();
+}
+#endif
+
+/**
+ * @brief   Same as Line, but with integer arithmetic only, for processors
+ *          without a (fast) FPU.
+ *
+ * The homogeneous coordinates are computed from the integer CosSin values
+ * directly, in Q#COEFFICIENT_BITS format. Coordinates of up to 16 bits are
+ * supported: the constant term has at most 38 bits, and all products in
+ * #intersect fit in 64 bits.
+ */
+class FixedPointLine {
+  public:
+    /// The number of fractional bits of the normal vector of the line.
+    constexpr static uint COEFFICIENT_BITS = 20;
+
+    FixedPointLine(Pixel p, CosSin slope)
+        : a(toFixed(slope.sin)), b(-toFixed(slope.cos)),
+          c(-a * int64_t(p.x) - b * int64_t(p.y)) {}
+
+    /// The distance from the line to the given point, times
+    /// 2^#COEFFICIENT_BITS. Positive on the right of the line.
+    int64_t signedDistance(Pixel point) const {
+        return a * int64_t(point.x) + b * int64_t(point.y) + c;
+    }
+
+    bool rightOfPoint(Pixel point) const { return signedDistance(point) >= 0; }
+
+    bool leftOfPoint(Pixel point) const { return signedDistance(point) <= 0; }
+
+    /**
+     * @brief   Get the point of intersection of two lines, rounded towards
+     *          zero to a multiple of 1/2^FixedPoint::FRACTION_BITS pixel.
+     *          Points that are more than 2^23 pixels away saturate.
+     *
+     * @return  The point of intersection, or `std::nullopt` if the lines are
+     *          parallel.
+     */
+    static std::optional<FixedPoint> intersect(FixedPointLine l,
+                                               FixedPointLine m) {
+        // Cross product of the homogeneous coordinates
+        int64_t x = l.b * m.c - l.c * m.b;
+        int64_t y = l.c * m.a - l.a * m.c;
+        int64_t w = l.a * m.b - l.b * m.a;
+        if (w == 0)
+            return std::nullopt;
+        return FixedPoint{divide(x, w), divide(y, w)};
+    }
+
+  private:
+    /// Convert a CosSin component to Q#COEFFICIENT_BITS, rounding to nearest.
+    static int64_t toFixed(int value) {
+        constexpr uint shift = 30 - COEFFICIENT_BITS;
+        return (int64_t(value) + (1 << (shift - 1))) >> shift;
+    }
+
+    /// Get n / d in Q FixedPoint::FRACTION_BITS, without overflowing.
+    /// Results that don't fit in 32 bits saturate.
+    static int32_t divide(int64_t n, int64_t d) {
+        constexpr int64_t one = 1 << FixedPoint::FRACTION_BITS;
+        constexpr int64_t max = INT32_MAX / one;
+        int64_t integer       = n / d;
+        if (integer > max)
+            return INT32_MAX;
+        if (integer < -max)
+            return -INT32_MAX;
+        int64_t fraction = (n % d) * one / d;
+        return integer * one + fraction;
+    }
+
+    /// The homogeneous coordinates (a, b, c) of the line a x + b y + c = 0.
+    int64_t a, b, c;
+};
@@ -1,21 +1,63 @@
 #pragma once
 
-#include <ANSIColors.hpp>
 #include <Angle.hpp>
+#include <BitScan.hpp>
 #include <Bresenham.hpp>
 #include <CenterPointOutLineIterator.hpp>
+#include <Config.hpp>
+#include <Diagnostics.hpp>
+#include <FixedPointLine.hpp>
 #include <HelperStructs.hpp>
+#include <Homography.hpp>
+#include <HoughCache.hpp>
 #include <Line.hpp>
+#include <MaskStorage.hpp>
 #include <Matrix.hpp>
+#include <OccupancyMap.hpp>
+#include <Parameters.hpp>
+#include <PerpendicularStencil.hpp>
+#include <ScratchArena.hpp>
+#include <SearchBudget.hpp>
 #include <algorithm>  // max_element
+#include <array>
 #include <cstdint>
-#include <iostream>
 #include <limits>
 #include <optional>
+#if GRID_FINDER_EXCEPTIONS
+#include <new>  // bad_alloc
+#include <stdexcept>
+#endif
+#if GRID_FINDER_IOSTREAM
+#include <iostream>
+#endif
 
+#ifndef GRID_FINDER_HOUGH_BATCH_SIZE
+/// See GridFinder::HOUGH_BATCH_SIZE.
+#define GRID_FINDER_HOUGH_BATCH_SIZE 1
+#endif
+
+#ifndef GRID_FINDER_FIXED_POINT_GEOMETRY
+/// Use FixedPointLine instead of Line for the intersections of the lines, so
+/// the search doesn't need floating point arithmetic. Enabled by default on
+/// ARM processors without an FPU.
+#if defined(__arm__) && !defined(__ARM_FP)
+#define GRID_FINDER_FIXED_POINT_GEOMETRY 1
+#else
+#define GRID_FINDER_FIXED_POINT_GEOMETRY 0
+#endif
+#endif
+
+#ifndef GRID_FINDER_PREFETCH_DISTANCE
+/// See GridFinder::PREFETCH_DISTANCE. Negative means that it depends on the
+/// size of the mask.
+#define GRID_FINDER_PREFETCH_DISTANCE -1
+#endif
+
+#if GRID_FINDER_IOSTREAM
 using std::cerr;
 using std::cout;
 using std::endl;
+#endif
 using std::optional;
 
 /**
@@ -25,52 +67,273 @@ using std::optional;
  *          The width of the image in pixels.
  * @tparam  H
  *          The height of the image in pixels.
+ * @tparam  Parameters
+ *          The detection thresholds, either #DefaultParameters (compile-time
+ *          constants) or #RuntimeParameters (can be changed without 
+ *          recompiling). See Parameters.hpp.
+ * @tparam  Storage
+ *          The memory layout of the mask, either #RowMajorStorage or
+ *          #TiledStorage. See MaskStorage.hpp. #UndistortedStorage corrects
+ *          the lens distortion, see UndistortedStorage.hpp.
  */
 #if 1
-template <size_t W, size_t H>
+template <size_t W, size_t H, class Parameters = DefaultParameters<W, H>,
+          class Storage = RowMajorStorage<W, H>>
 #else
 constexpr uint H = 308;
 constexpr uint W = 410;
+using Parameters = DefaultParameters<W, H>;
+using Storage    = RowMajorStorage<W, H>;
 #endif
 class GridFinder {
   public:
     /// The type of the image mask.
     using Img_t = TMatrix<uint8_t, H, W>;
+    /// The type of the detection thresholds.
+    using Parameters_t = Parameters;
+    /// The memory layout of the mask.
+    using Storage_t = Storage;
 
     /// Constructor from a given mask.
-    GridFinder(const Img_t &mask) : mask(mask) {}
+    GridFinder(const Img_t &mask, const Parameters &params = {})
+        : mask(mask), occupancy(mask), params(params) {
+        if (!checkParameters(params))
+            parameterStatus = SearchStatus::InvalidParameters;
+    }
     /// Default constructor (creates a mask of all zeros).
     GridFinder() : mask{} {}
 
-#pragma region Finding the angle of a line......................................
+#pragma region Parameters.......................................................
 
-    /// When this many consecutive black pixels are encountered, stop following
-    /// the line.
-    constexpr static uint HOUGH_MAX_GAP = 16;
+    /// Get the detection thresholds.
+    const Parameters &getParameters() const { return params; }
+
+    /**
+     * @brief   Change the detection thresholds. Only useful for 
+     *          #RuntimeParameters.
+     * 
+     * @throws  std::invalid_argument
+     *          If any of the parameters is invalid. Without exceptions, the
+     *          parameters are not changed, and #findSquare fails with
+     *          SearchStatus::InvalidParameters until valid parameters are set.
+     */
+    void setParameters(const Parameters &params) {
+        if (!checkParameters(params)) {
+            parameterStatus = SearchStatus::InvalidParameters;
+            return;
+        }
+        parameterStatus = SearchStatus::Ok;
+        this->params    = params;
+        houghCache.clear();
+    }
+
+    /// @copydoc setParameters
+    /// @return False if any of the parameters is invalid (only without
+    ///         exceptions).
+    static bool checkParameters(const Parameters &params) {
+        const char *error = getParameterError(params);
+#if GRID_FINDER_EXCEPTIONS
+        if (error)
+            throw std::invalid_argument(error);
+#endif
+        return error == nullptr;
+    }
+
+    /// Get a description of the first invalid parameter, or a null pointer if
+    /// all parameters are valid.
+    static const char *getParameterError(const Parameters &params) {
+        if (params.FIRST_LINE_INVALID_HORIZONTAL_JUMP == 0)
+            return "Error: FIRST_LINE_INVALID_HORIZONTAL_JUMP must be positive";
+        if (params.MAX_LINE_WIDTH == 0)
+            return "Error: MAX_LINE_WIDTH must be positive";
+        if (params.MAX_LINE_WIDTH >= STENCIL_LENGTH)
+            return "Error: MAX_LINE_WIDTH must be less than STENCIL_LENGTH";
+        if (params.HOUGH_ANGLE_STEP == 0)
+            return "Error: HOUGH_ANGLE_STEP must be positive";
+        if (2 * params.ACCURATE_ANGLE_RANGE >= angle_t::resolution())
+            return "Error: ACCURATE_ANGLE_RANGE must be less than half of the "
+                   "angle resolution";
+        if (params.MAXIMUM_WHITE_PERCENTAGE > 100)
+            return "Error: MAXIMUM_WHITE_PERCENTAGE must be at most 100";
+        return nullptr;
+    }
+
+#pragma endregion
+
+#pragma region Finding the angle of a line......................................
 
     /**
      * @brief   Starting from the given pixel, move in the direction of the 
      *          given angle, and count the number of white pixels, weighing them
-     *          more as the distance increases. When more than #HOUGH_MAX_GAP 
-     *          consecutive black pixels are encountered, stop looking any 
-     *          farther.
+     *          more as the distance increases. When more than 
+     *          Parameters::HOUGH_MAX_GAP consecutive black pixels are 
+     *          encountered, stop looking any farther.  
+     *          The results are cached until the end of the frame, so rays that
+     *          are scanned multiple times (e.g. by overlapping calls to
+     *          #findLineAngleAccurateRange) are only followed once.
      * @param   px
      *          The starting point.
      * @param   angle
      *          The direction to look in.
      */
     HoughResult hough(Pixel px, angle_t angle) const {
-        BresenhamLine line = {px, angle, W, H};
-        uint previousWhite = 0;
-        while (line.hasNext()) {
-            Pixel point = line.next();
-            // If pixel is white
-            if (get(point))
-                previousWhite = line.getCurrentLength();
-            else if (line.getCurrentLength() - previousWhite >= HOUGH_MAX_GAP)
-                break;
+        HoughResult result;
+        houghBatch({&px, 1}, {&angle, 1}, {&result, 1});
+        return result;
+    }
+
+    /**
+     * @brief   The number of rays that are followed in lockstep by #houghBatch.
+     * 
+     * Interleaving rays only pays off if the processor can't hide the memory
+     * latency itself: keeping the state of multiple rays in memory instead of
+     * in registers makes each step slower. On out-of-order x86 cores, a batch
+     * size of one is fastest, even for 1920×1080 masks that don't fit in the
+     * cache. Simple in-order cores might benefit from a larger batch, it can
+     * be set by defining `GRID_FINDER_HOUGH_BATCH_SIZE`.
+     */
+    constexpr static uint HOUGH_BATCH_SIZE = GRID_FINDER_HOUGH_BATCH_SIZE;
+
+    /**
+     * @brief   The number of steps ahead of the current pixel that the pixels
+     *          of a ray are prefetched, or zero to disable prefetching.
+     * 
+     * Rows of the mask are W bytes apart, so a steep ray touches a new cache
+     * line on every step, and a new page every few rows, where the hardware
+     * prefetcher gives up. Masks that fit in the cache don't benefit, so
+     * prefetching is only enabled for large masks by default. It can be set
+     * by defining `GRID_FINDER_PREFETCH_DISTANCE`.
+     */
+    constexpr static uint PREFETCH_DISTANCE =
+        GRID_FINDER_PREFETCH_DISTANCE >= 0 ? GRID_FINDER_PREFETCH_DISTANCE
+        : W * H >= (1 << 20)               ? 16
+                                           : 0;
+
+    /// The number of steps of each ray between checks of the search budget.
+    constexpr static uint HOUGH_BUDGET_CHECK_INTERVAL = 64;
+
+    /**
+     * @brief   Same as #hough, but for many rays at once.
+     * 
+     * The rays are followed in groups of @p BatchSize, taking one step of
+     * each ray in turn, instead of following one ray to the end before
+     * starting the next one. After each step, the next pixel of the ray is
+     * prefetched (or the pixel #PREFETCH_DISTANCE steps ahead), so the memory
+     * accesses of the different rays overlap.
+     * 
+     * This is the single place where the throughput of the ray walks is
+     * optimized, all angle searches use it.
+     * 
+     * @tparam  BatchSize
+     *          The number of rays to follow in lockstep.
+     * @param   pixels
+     *          The starting points of the rays. Either one per angle, or a
+     *          single pixel that's used for all angles.
+     * @param   angles
+     *          The directions of the rays.
+     * @param   results
+     *          The output, one result per angle.
+     * @return  False if any of the rays was skipped or abandoned because the
+     *          search budget ran out. Their results are zero, so the
+     *          histogram is incomplete.
+     * 
+     * @throws  std::invalid_argument
+     *          If the sizes of the spans don't match. Without exceptions, the
+     *          search is cancelled and all results are zero.
+     */
+    template <uint BatchSize = HOUGH_BATCH_SIZE>
+    bool houghBatch(Span<const Pixel> pixels, Span<const angle_t> angles,
+                    Span<HoughResult> results) const {
+        static_assert(BatchSize > 0);
+        if ((pixels.size() != 1 && pixels.size() != angles.size()) ||
+            results.size() != angles.size()) {
+            std::fill(results.begin(), results.end(), HoughResult{});
+            fail(SearchStatus::InvalidArgument,
+                 "Error: houghBatch sizes don't match");
+            return false;
         }
-        return {angle, previousWhite};
+        auto pixel = [&](size_t i) {
+            return pixels.size() == 1 ? pixels[0] : pixels[i];
+        };
+
+        std::array<optional<BresenhamLine>, BatchSize> lines;
+        std::array<uint, BatchSize> previousWhite;
+        std::array<Pixel, BatchSize> lookahead;
+        uint steps    = 0;
+        bool complete = true;
+        for (size_t first = 0; first < angles.size(); first += BatchSize) {
+            const size_t n = std::min<size_t>(BatchSize, angles.size() - first);
+            // A ray is done when it falls off the canvas, or when it
+            // encounters too many consecutive black pixels
+            auto finish = [&](size_t i) {
+                const angle_t angle = angles[first + i];
+                houghCache.insert(pixel(first + i), angle.getIndex(),
+                                  previousWhite[i]);
+                results[first + i] = {angle, previousWhite[i]};
+                lines[i].reset();
+            };
+            uint active = 0;
+            // Start the rays that are not in the cache
+            for (size_t i = 0; i < n; ++i) {
+                const angle_t angle = angles[first + i];
+                lines[i].reset();
+                previousWhite[i] = 0;
+                // If we ran out of time, don't look any farther
+                if (budget.exhausted()) {
+                    results[first + i] = {angle, 0};
+                    complete           = false;
+                } else if (uint count; houghCache.lookup(
+                             pixel(first + i), angle.getIndex(), count))
+                    results[first + i] = {angle, count};
+                else if (lines[i].emplace(pixel(first + i), angle, roi);
+                         lines[i]->hasNext()) {
+                    lookahead[i] = lines[i]->getLookahead(PREFETCH_DISTANCE);
+                    ++active;
+                } else
+                    finish(i);
+            }
+            // Take one step of each ray that's still active
+            for (uint round = 1; active > 0; ++round) {
+                steps += active;
+                for (size_t i = 0; i < n; ++i) {
+                    if (!lines[i].has_value())
+                        continue;
+                    BresenhamLine &line = *lines[i];
+                    Pixel point         = line.next();
+                    uint length         = line.getCurrentLength();
+                    bool done           = !line.hasNext();
+                    // If pixel is white
+                    if (get(point))
+                        previousWhite[i] = length;
+                    else if (length - previousWhite[i] >= params.HOUGH_MAX_GAP)
+                        done = true;
+                    if (done) {
+                        finish(i);
+                        --active;
+                    } else if (PREFETCH_DISTANCE > 0) {
+                        prefetchAhead(point, lookahead[i]);
+                    } else if (BatchSize > 1) {
+                        prefetch(line.peek());
+                    }
+                }
+                // Checking the budget after every step would be too slow
+                if (round % HOUGH_BUDGET_CHECK_INTERVAL != 0 && active > 0)
+                    continue;
+                budget.charge(steps);
+                steps = 0;
+                // If we ran out of time, abandon the rays that are still active
+                if (active > 0 && budget.exhausted()) {
+                    for (size_t i = 0; i < n; ++i) {
+                        if (lines[i].has_value())
+                            results[first + i] = {angles[first + i], 0};
+                        lines[i].reset();
+                    }
+                    active   = 0;
+                    complete = false;
+                }
+            }
+        }
+        return complete;
     }
 
     /** 
@@ -80,12 +343,23 @@ class GridFinder {
      *          count.  
      *          On the other hand, it's a bit faster than the more accurate 
      *          alternatives, making it a good candidate for finding the first
-     *          angle estimate, to narrow down the search space.
+     *          angle estimate, to narrow down the search space.  
+     *          Only every Parameters::HOUGH_ANGLE_STEP-th angle is scanned.
+     * 
+     * @return  The angle with the most votes, or nothing if the search budget
+     *          ran out before all rays were followed.
      */
-    HoughResult findLineAngle(Pixel px) const {
-        std::array<HoughResult, angle_t::resolution()> houghRes;
-        for (uint i = 0; i < angle_t::resolution(); ++i)
-            houghRes.at(i) = hough(px, angle_t(i));
+    optional<HoughResult> findLineAngle(Pixel px) const {
+        typename Scratch_t::Scope scope = scratch;
+        const uint step                 = params.HOUGH_ANGLE_STEP;
+        const uint count = (angle_t::resolution() + step - 1) / step;
+        Span<angle_t> angles = scratch.template allocate<angle_t>(count);
+        Span<HoughResult> houghRes =
+            scratch.template allocate<HoughResult>(count);
+        for (uint i = 0; i < count; ++i)
+            angles[i] = angle_t(i * step);
+        if (!houghBatch({&px, 1}, angles, houghRes))
+            return std::nullopt;
         return *std::max_element(houghRes.begin(), houghRes.end());
     }
 
@@ -129,56 +403,48 @@ class GridFinder {
      *          it uses the average of the range of angles with the hightest
      *          vote counts. It also doesn't scan 360°, but takes 2@p N samples 
      *          around a given center angle.
+     *          The width of the peak is returned as well, as a measure of
+     *          how sharp the angle is (see #lineConfidence).
+     * 
+     * @return  The peak, or nothing if the search budget ran out before all
+     *          rays were followed: a partial histogram could put the peak
+     *          anywhere in the range.
      */
     template <uint N>
-    HoughResult findLineAngleAccurateRange(Pixel px,
-                                           angle_t centerAngle) const {
+    optional<HoughPeak> findLineAngleAccurateRange(Pixel px,
+                                                   angle_t centerAngle) const {
         static_assert(2 * N < angle_t::resolution());
-        std::array<HoughResult, 2 * N + 1> houghRes;
+        return findLineAngleAccurateRange(px, centerAngle, N);
+    }
+
+    /// @copydoc findLineAngleAccurateRange
+    /// This version takes the number of samples @p N as a runtime argument.
+    optional<HoughPeak> findLineAngleAccurateRange(Pixel px,
+                                                   angle_t centerAngle,
+                                                   uint N) const {
+        if (2 * N >= angle_t::resolution()) {
+            fail(SearchStatus::OutOfRange, "N out of range");
+            return std::nullopt;
+        }
+        typename Scratch_t::Scope scope = scratch;
+        Span<angle_t> angles = scratch.template allocate<angle_t>(2 * N + 1);
+        Span<HoughResult> houghRes =
+            scratch.template allocate<HoughResult>(2 * N + 1);
         uint centerAngleIndex = centerAngle.getIndex();
 
-        // If the range contains no discontinuities
-        // ├───┬───┬───╤═══╤═══╤═══╪═══╤═══╤═══╤───┬───┬───┤
-        // 0          C-N          C          C+N         R-1
+        // The range could contain the 0-2π discontinuity, so wrap around
+        // ╞═══╪═══╤═══╤═══╤───┬───┬───┬───┬───┬───┬───╤═══╡
+        // 0   C          C+N                         C-N R-1
         // C = center
         // N = number of steps around the center
         // R = resolution (R steps = 720°)
-        if (centerAngleIndex - N < angle_t::resolution() &&
-            centerAngleIndex + N < angle_t::resolution()) {
-            uint initialAngleIndex = centerAngleIndex - N;
-            for (uint i = 0; i <= 2 * N; ++i)
-                houghRes.at(i) = hough(px, angle_t(initialAngleIndex + i));
-        }
-        // If the 0-2π discontinuity is in the first part of the range
-        // (< centerAngle)
-        // ╞═══╪═══╤═══╤═══╤───┬───┬───┬───┬───┬───┬───╤═══╡
-        // 0   C          C+N                         C-N R-1
-        else if (centerAngleIndex + N < angle_t::resolution()) {
-            uint initialAngleIndex =
-                angle_t::resolution() + centerAngleIndex - N;
-            uint i = 0;
-            for (uint j = initialAngleIndex; j < angle_t::resolution();
-                 ++i, ++j)
-                houghRes.at(i) = hough(px, angle_t(j));
-            for (uint j = 0; j <= centerAngleIndex + N; ++i, ++j)
-                houghRes.at(i) = hough(px, angle_t(j));
-        }
-        // If the 0-2π discontinuity is in the second part of the range
-        // (> centerAngle)
-        // ╞═══╤───┬───┬───┬───┬───┬───┬───╤═══╤═══╤═══╪═══╡
-        // 0  C+N                         C-N          C  R-1
-        else if (angle_t::resolution() - N < angle_t::resolution()) {
-            uint initialAngleIndex = centerAngleIndex - N;
-            uint i                 = 0;
-            for (uint j = initialAngleIndex; j < angle_t::resolution();
-                 ++i, ++j)
-                houghRes.at(i) = hough(px, angle_t(j));
-            for (uint j = 0; j <= N + centerAngleIndex - angle_t::resolution();
-                 ++i, ++j)
-                houghRes.at(i) = hough(px, angle_t(j));
-        } else {
-            throw std::runtime_error("Something is very wrong");
-        }
+        uint initialAngleIndex = angle_t::resolution() + centerAngleIndex - N;
+        for (uint i = 0; i <= 2 * N; ++i)
+            angles[i] =
+                angle_t((initialAngleIndex + i) % angle_t::resolution());
+        if (!houghBatch({&px, 1}, angles, houghRes))
+            return std::nullopt;
+
         // If there are multiple elements with the same maximum count,
         // max_element will return an iterator to the first element with this
         // count
@@ -209,19 +475,22 @@ class GridFinder {
                          houghRes.end(), predicateLessThanSevenEighths);
 
         if (first_max == houghRes.rend() || last_max == houghRes.end())
-            cerr << ANSIColors::yellow
-                 << "Warning: angle with maximum count could lie outside of "
-                    "the specified range\r\n"
-                 << ANSIColors::reset;
+            diagnose(DiagnosticEvent::MaximumAtRangeEdge, px, max->angle,
+                     max->count);
 
         if (first_max != houghRes.rbegin())
             --first_max;
         if (last_max != houghRes.begin())
             --last_max;
 
-        return {
-            angle_t::average(first_max->angle, last_max->angle),
-            first_max->count,  // TODO: should this be max->count?
+        // first_max.base() points to the element after *first_max
+        uint peakWidth = last_max - first_max.base() + 2;
+        return HoughPeak{
+            {
+                angle_t::average(first_max->angle, last_max->angle),
+                first_max->count,  // TODO: should this be max->count?
+            },
+            peakWidth,
         };
     }
 
@@ -229,18 +498,22 @@ class GridFinder {
 
 #pragma region Finding the middle of a line.....................................
 
+    /// The maximum number of pixels of a perpendicular width probe, 
+    /// Parameters::MAX_LINE_WIDTH must be smaller.
+    constexpr static uint STENCIL_LENGTH = 64;
     /**
-     * @brief   The maximum number of pixels that can be black within a line,
-     *          while still being detected correctly.
-     */
-    static const uint MAX_GAP = 10;
-
-    /**
-     * @brief   "Lines" that are wider than this value are ignored, to prevent
-     *          white blobs (of sunlight, for example) from being detected as
-     *          random lines.
+     * @brief   The number of pixels of a width probe that are checked at once.
+     * 
+     * Most lines are much narrower than Parameters::MAX_LINE_WIDTH, so
+     * checking all pixels of the stencil at once does a lot of unnecessary
+     * work. Blocks of four pixels were fastest on the test mask, larger
+     * blocks are slower (32 is slower than following a BresenhamLine).
      */
-    static const uint MAX_LINE_WIDTH = 32;
+    constexpr static uint PROBE_BLOCK_SIZE = 4;
+    /// The lookup tables for the perpendicular width probes.
+    using Stencils_t = PerpendicularStencils<angle_t, STENCIL_LENGTH>;
+    /// The pixels of one perpendicular width probe.
+    using Stencil = typename Stencils_t::Stencil;
 
     /**
      * @brief   Get the width of the line at a given point.
@@ -251,8 +524,8 @@ class GridFinder {
      * line from the base line is known.  
      * Finally, the maximum of all distances is returned.
      * 
-     * If the width at any point exceeds the #MAX_LINE_WIDTH, #MAX_LINE_WIDTH is 
-     * returned.
+     * If the width at any point exceeds Parameters::MAX_LINE_WIDTH, 
+     * Parameters::MAX_LINE_WIDTH is returned.
      * 
      * @param   pixel
      *          A point on the line.
@@ -268,37 +541,16 @@ class GridFinder {
      *          The maximum half width of the line, over the @p maxLineGap
      *          pixels along the given line.
      */
-    uint getWidthAtPointOnLine(Pixel pixel, CosSin angle,
-                               uint maxLineGap = MAX_GAP,
-                               bool plus90deg  = true) const {
-        BresenhamLine alongLine   = {pixel, angle, W, H};
-        CosSin perpendicularAngle = angle.perpendicular(plus90deg);
-        uint maxWidthSoFar        = 0;
-        // Follow a path along the given line for maxLineGap pixels
-        for (uint i = 0; i <= maxLineGap && alongLine.hasNext(); ++i) {
-            Pixel pixelAlongLine = alongLine.next();
-            // For each pixel along this path, move away from the line,
-            // perpendicular to it, until you find a black pixel, until you
-            // fall off the canvas, or until the maximum line width is exceeded.
-            BresenhamLine perpendicular = {pixelAlongLine, perpendicularAngle,
-                                           W, H};
-            while (perpendicular.hasNext() &&
-                   perpendicular.getCurrentLength() <= MAX_LINE_WIDTH) {
-                Pixel pixel = perpendicular.next();
-                if (get(pixel) == 0x00)
-                    break;
-            }
-            if (perpendicular.getCurrentLength() > MAX_LINE_WIDTH)
-                // throw std::runtime_error("Error: Endless loop detected");
-                return MAX_LINE_WIDTH;
+    uint getWidthAtPointOnLine(Pixel pixel, angle_t angle, uint maxLineGap,
+                               bool plus90deg = true) const {
+        return getWidthAlongLine(pixel, angle, Stencils_t::get(angle),
+                                 plus90deg ? 1 : -1, maxLineGap);
+    }
 
-            // If we found a black pixel before exceeding the maximum line width
-            if (perpendicular.getCurrentLength() > maxWidthSoFar)
-                // getCurrentLength() gives the length to the first black pixel,
-                // so that's one pixel too much. Fix at the end of the function.
-                maxWidthSoFar = perpendicular.getCurrentLength();
-        }
-        return maxWidthSoFar - 1;
+    /// @copydoc getWidthAtPointOnLine
+    /// Uses Parameters::MAX_GAP as the maximum line gap.
+    uint getWidthAtPointOnLine(Pixel pixel, angle_t angle) const {
+        return getWidthAtPointOnLine(pixel, angle, params.MAX_GAP);
     }
 
     /**
@@ -312,37 +564,45 @@ class GridFinder {
      *          The maximum gap of black pixels that can be recovered.
      * @return  // TODO 
      */
-    optional<GetMiddleResult> getMiddle(Pixel pointOnLine, CosSin lineAngle,
-                                        uint maxLineGap = MAX_GAP) const {
+    optional<GetMiddleResult> getMiddle(Pixel pointOnLine, angle_t lineAngle,
+                                        uint maxLineGap) const {
         // If the given point does not lie on a line, we can't find the middle
         // of the line
         if (get(pointOnLine) == 0x00)
             return std::nullopt;
 
-        CosSin oppositeAngle = lineAngle.opposite();
+        CosSin lineCosSin     = lineAngle;
+        CosSin oppositeAngle  = lineCosSin.opposite();
+        const Stencil &upward = Stencils_t::get(lineAngle);
         // Get the half width of the line in four directions.
         // U2   U1
         // ↑↑↑ ↑↑↑
         // ---o---> line
         // ↓↓↓ ↓↓↓
         // L2   L1
-        uint widthUpper1 = getWidthAtPointOnLine(pointOnLine, lineAngle,  //
-                                                 maxLineGap / 2, true);
-        uint widthLower1 = getWidthAtPointOnLine(pointOnLine, lineAngle,  //
-                                                 maxLineGap / 2, false);
-        uint widthUpper2 = getWidthAtPointOnLine(pointOnLine, oppositeAngle,  //
-                                                 maxLineGap / 2, false);
-        uint widthLower2 = getWidthAtPointOnLine(pointOnLine, oppositeAngle,  //
-                                                 maxLineGap / 2, true);
+        // The perpendicular of the opposite angle is the same as the 
+        // perpendicular of the line angle, in the other direction.
+        uint widthUpper1 = getWidthAlongLine(pointOnLine, lineCosSin,  //
+                                             upward, 1, maxLineGap / 2);
+        uint widthLower1 = getWidthAlongLine(pointOnLine, lineCosSin,  //
+                                             upward, -1, maxLineGap / 2);
+        uint widthUpper2 = getWidthAlongLine(pointOnLine, oppositeAngle,  //
+                                             upward, 1, maxLineGap / 2);
+        uint widthLower2 = getWidthAlongLine(pointOnLine, oppositeAngle,  //
+                                             upward, -1, maxLineGap / 2);
 
         // Use the maximum of the upper width and the maximum of the lower width
         uint widthUpper = std::max(widthUpper1, widthUpper2);
         uint widthLower = std::max(widthLower1, widthLower2);
 
-        // If either of the widths exceeds the #MAX_LINE_WIDTH, the result is
-        // invalid: it is probably a large white spot, not a thin line
-        if (widthUpper >= MAX_LINE_WIDTH || widthLower >= MAX_LINE_WIDTH)
+        // If either of the widths exceeds the maximum line width, the result
+        // is invalid: it is probably a large white spot, not a thin line
+        if (widthUpper >= params.MAX_LINE_WIDTH ||
+            widthLower >= params.MAX_LINE_WIDTH) {
+            diagnose(DiagnosticEvent::LineRejectedWidth, pointOnLine,
+                     lineAngle, widthUpper + widthLower);
             return std::nullopt;
+        }
 
         // Use the difference between the two widths to move the given point
         // towards the center
@@ -350,14 +610,21 @@ class GridFinder {
         uint middlePointCorrDistance = std::abs(middlePointCorrection_x2) / 2;
         // Should we move up or down? (+90° or -90° from the estimated angle)
         bool corrDirection = middlePointCorrection_x2 > 0;
-        CosSin corrAngle   = lineAngle.perpendicular(corrDirection);
+        CosSin corrAngle   = lineCosSin.perpendicular(corrDirection);
         Pixel middle = move(pointOnLine, corrAngle, middlePointCorrDistance);
-        return GetMiddleResult{middle, widthUpper + widthLower - 1};
+        // The widths on both sides of the point should be the same
+        uint width1 = widthUpper1 + widthLower1;
+        uint width2 = widthUpper2 + widthLower2;
+        uint spread = width1 > width2 ? width1 - width2 : width2 - width1;
+        return GetMiddleResult{middle, widthUpper + widthLower - 1, spread};
     }
 
-    /// When we're at an intersection and no width can be determined, how
-    /// far should we jump along the line before trying again.
-    constexpr static uint RETRY_JUMP_DISTANCE = MAX_LINE_WIDTH;  // TODO
+    /// @copydoc getMiddle
+    /// Uses Parameters::MAX_GAP as the maximum line gap.
+    optional<GetMiddleResult> getMiddle(Pixel pointOnLine,
+                                        angle_t lineAngle) const {
+        return getMiddle(pointOnLine, lineAngle, params.MAX_GAP);
+    }
 
     /**
      * @brief   In exceptional cases, we might want to find the middle of a line
@@ -377,14 +644,142 @@ class GridFinder {
                                                    angle_t angle) const {
         optional<GetMiddleResult> middle = std::nullopt;
         Pixel previousPixel;
+        uint attempts = 0;
         do {
             previousPixel = start;
             middle        = getMiddle(start, angle);
-            start         = move(start, angle, RETRY_JUMP_DISTANCE);
-        } while (!middle.has_value() && previousPixel != start);
+            start         = move(start, angle, params.RETRY_JUMP_DISTANCE);
+            ++attempts;
+        } while (!middle.has_value() && previousPixel != start &&
+                 !budget.exhausted());
+        if (!middle.has_value())
+            diagnose(DiagnosticEvent::RetriesExhausted, previousPixel, angle,
+                     attempts);
         return middle;
     }
 
+  private:
+    /**
+     * @brief   Implementation of #getWidthAtPointOnLine.
+     * 
+     * @param   pixel
+     *          A point on the line.
+     * @param   angle
+     *          The direction to move in along the line.
+     * @param   perpendicular
+     *          The stencil of the direction perpendicular to the line.
+     * @param   sign
+     *          +1 to follow the stencil, -1 to follow it in the opposite 
+     *          direction.
+     * @param   maxLineGap
+     *          The number of width samples.
+     */
+    uint getWidthAlongLine(Pixel pixel, CosSin angle,
+                           const Stencil &perpendicular, int sign,
+                           uint maxLineGap) const {
+        BresenhamLine alongLine = {pixel, angle, roi};
+        uint maxWidthSoFar      = 0;
+        // Follow a path along the given line for maxLineGap pixels
+        for (uint i = 0; i <= maxLineGap && alongLine.hasNext(); ++i) {
+            // For each pixel along this path, move away from the line,
+            // perpendicular to it, until you find a black pixel, until you
+            // fall off the canvas, or until the maximum line width is exceeded.
+            uint length = probeWidth(alongLine.next(), perpendicular, sign);
+            budget.charge(length);
+            if (length > params.MAX_LINE_WIDTH)
+                return params.MAX_LINE_WIDTH;
+
+            // If we found a black pixel before exceeding the maximum line width
+            if (length > maxWidthSoFar)
+                // The length includes the first black pixel, so that's one
+                // pixel too much. Fix at the end of the function.
+                maxWidthSoFar = length;
+        }
+        return maxWidthSoFar - 1;
+    }
+
+    /**
+     * @brief   Follow the given stencil from the start pixel, until a black 
+     *          pixel is encountered, until the edge of the region of interest,
+     *          or until Parameters::MAX_LINE_WIDTH is exceeded.
+     * 
+     * The stencil is a fixed table, so #PROBE_BLOCK_SIZE pixels can be
+     * checked at once without any branches: the pixels that are black or
+     * outside of the region are collected in a bit mask, and the first one is
+     * found using a bit scan.
+     *
+     * Unlike the Hough rays, the probes are not prefetched (see
+     * #PREFETCH_DISTANCE): the addresses don't depend on the previous step,
+     * so the loads of a block are already issued in parallel. Prefetching
+     * the pixels ahead only added work, even on large masks.
+     *
+     * @return  The number of pixels up to and including the first black pixel,
+     *          the number of pixels inside of the region if the edge was 
+     *          reached first, or Parameters::MAX_LINE_WIDTH + 1 if the line is
+     *          too wide.
+     */
+    uint probeWidth(Pixel start, const Stencil &stencil, int sign) const {
+        const uint length = params.MAX_LINE_WIDTH + 1;
+        for (uint first = 0; first < length; first += PROBE_BLOCK_SIZE) {
+            const uint n  = std::min(PROBE_BLOCK_SIZE, length - first);
+            uint32_t stop = 0, outside = 0;
+            for (uint i = 0; i < n; ++i) {
+                StencilOffset offset = stencil[first + i];
+                Pixel px             = {start.x + sign * offset.x,
+                                        start.y + sign * offset.y};
+                bool inside          = roi.contains(px);
+                // Don't read outside of the mask
+                bool white = get(inside ? px : start) != 0x00;
+                outside |= uint32_t(!inside) << i;
+                stop |= uint32_t(!inside || !white) << i;
+            }
+            if (stop != 0) {
+                uint i = countTrailingZeros(stop);
+                return first + i + (outside >> i & 1 ? 0 : 1);
+            }
+        }
+        return length;
+    }
+
+  public:
+
+#pragma endregion
+
+#pragma region Region of interest...............................................
+
+    /**
+     * @brief   Only search for the square inside of the given region. All
+     *          search functions only access the pixels inside of this region.
+     *          The vote count thresholds are scaled down proportionally to 
+     *          the size of the region.
+     * 
+     * @param   region
+     *          The region to search in, it's clipped to the frame.
+     */
+    void setRegionOfInterest(Rect region) {
+        region.x      = std::min<uint>(region.x, W);
+        region.y      = std::min<uint>(region.y, H);
+        region.width  = std::min<uint>(region.width, W - region.x);
+        region.height = std::min<uint>(region.height, H - region.y);
+        roi           = region;
+        houghCache.clear();
+    }
+
+    /// Search the entire frame again.
+    void resetRegionOfInterest() {
+        roi = {0, 0, W, H};
+        houghCache.clear();
+    }
+
+    /// Get the region that's currently being searched.
+    Rect getRegionOfInterest() const { return roi; }
+
+    /// Scale a vote count threshold for the full frame to the size of the
+    /// region of interest.
+    uint scaleToRegion(uint count) const {
+        return count * (roi.width + roi.height) / (W + H);
+    }
+
 #pragma endregion
 
 #pragma region Getting and Setting Pixels.......................................
@@ -397,7 +792,9 @@ class GridFinder {
      *          The y-coordinate of the pixel to check.
      * @return  The value of the given pixel.
      */
-    inline constexpr uint8_t get(uint x, uint y) const { return mask[y][x]; }
+    inline constexpr uint8_t get(uint x, uint y) const {
+        return mask.get(x, y);
+    }
     /**
      * @brief   Get the value of the given pixel.
      * 
@@ -414,14 +811,31 @@ class GridFinder {
      * @param   value
      *          The value to set the pixel to.
      */
-    inline constexpr void set(Pixel px, uint8_t value = 0xFF) {
-        mask[px.y][px.x] = value;
+    inline void set(Pixel px, uint8_t value = 0xFF) {
+        // The occupancy map counts the pixels of the input mask, so update
+        // the cell of the pixel that's actually written
+        Pixel src = mask.source(px.x, px.y);
+        if (src.isValid())
+            occupancy.update(src.x, src.y, get(px), value);
+        mask.set(px.x, px.y, value);
+        houghCache.clear();
+    }
+    /**
+     * @brief   Replace the entire mask, e.g. by the next frame of a stream.
+     *          The parameters, the region of interest and the diagnostics are
+     *          kept, so one GridFinder can be reused for all frames.
+     */
+    void setMask(const Img_t &mask) {
+        this->mask = Storage(mask);
+        occupancy  = Occupancy_t(mask);
+        houghCache.clear();
     }
 
 #pragma endregion
 
 #pragma region Printing and Drawing.............................................
 
+#if GRID_FINDER_IOSTREAM
     /// Print the mask as "pixels" to the given output stream.
     std::ostream &print(std::ostream &os) const {
         for (uint y = 0; y < H; ++y) {
@@ -435,17 +849,17 @@ class GridFinder {
     /// Print the mask as a C++ Matrix to the given output stream.
     std::ostream &printMaskMatrix(std::ostream &os) const {
         os << "TMatrix<uint8_t, " << H << ", " << W << "> mask = {{\r\n";
-        for (const auto &row : mask) {
+        for (uint y = 0; y < H; ++y) {
             os << "    {";
-            uint ctr = W;
-            for (uint8_t el : row) {
-                os << std::hex << std::showbase << +el
-                   << (--ctr == 0 ? "" : ", ");
+            for (uint x = 0; x < W; ++x) {
+                os << std::hex << std::showbase << +get(x, y)
+                   << (x + 1 == W ? "" : ", ");
             }
             os << "},\r\n";
         }
         return os << "}};";
     }
+#endif
 
     /// Draw a line on the mask. Used only for testing.
     uint drawLine(Pixel pixel, int cos, int sin) {
@@ -468,6 +882,47 @@ class GridFinder {
 
 #pragma region Utilities........................................................
 
+    /// The size of the scratch memory for per-frame temporaries in bytes.
+    constexpr static size_t SCRATCH_SIZE = 16 * 1024;
+    /// The type of the arena for per-frame temporaries.
+    using Scratch_t = ScratchArena<SCRATCH_SIZE>;
+    // The largest temporaries are the angles and Hough results of
+    // #findLineAngle, so the arena can never overflow, even without
+    // exceptions.
+    static_assert(SCRATCH_SIZE >= angle_t::resolution() *
+                                          (sizeof(angle_t) +
+                                           sizeof(HoughResult)) +
+                                      alignof(HoughResult),
+                  "Scratch memory too small for the angle resolution");
+
+    /// Get the arena that's used for per-frame temporaries.
+    const Scratch_t &getScratch() const { return scratch; }
+
+    /// The number of Hough results that are cached per frame.
+    constexpr static size_t HOUGH_CACHE_SIZE = 4096;
+    /// The type of the cache for Hough results.
+    using HoughCache_t = HoughCache<HOUGH_CACHE_SIZE>;
+
+    /// Get the hit and miss counts of the Hough cache during the last
+    /// #findSquare call.
+    typename HoughCache_t::Stats getHoughCacheStats() const {
+        return houghCache.getStats();
+    }
+
+    /// The number of diagnostic events that are buffered before new events
+    /// are dropped.
+    constexpr static size_t DIAGNOSTICS_CAPACITY = 256;
+    /// The type of the buffer for diagnostic events.
+    using Diagnostics_t = DiagnosticsRing<DIAGNOSTICS_CAPACITY>;
+
+    /**
+     * @brief   Get the diagnostic events of the searches so far. The thread
+     *          that calls #findSquare is the producer, one other thread can
+     *          drain the events at the same time.
+     * @see     Diagnostics.hpp
+     */
+    Diagnostics_t &getDiagnostics() { return diagnostics; }
+
     /** 
      * @brief   Move a pixel in a given direction for a given distance.
      * 
@@ -480,33 +935,55 @@ class GridFinder {
      * @return  The pixel after the move.
      */
     Pixel move(Pixel start, CosSin angle, uint distance) const {
-        BresenhamLine path = {start, angle, W, H};
+        BresenhamLine path = {start, angle, roi};
         Pixel end;
         while (path.hasNext() && path.getCurrentLength() <= distance)
             end = path.next();
+        budget.charge(path.getCurrentLength());
         return end;
     }
 
-    /// Get the center pixel of the frame.
-    constexpr static Pixel center() { return {(W - 1) / 2, (H - 1) / 2}; }
+    /// Hint to the processor that the given pixel will be read soon.
+    void prefetch(Pixel px) const {
+#if defined(__GNUC__)
+        __builtin_prefetch(mask.address(px.x, px.y));
+#else
+        (void) px;
+#endif
+    }
+
+    /// Prefetch the pixel at the given offset from @p px, if it lies within
+    /// the mask.
+    /// @see    BresenhamLine::getLookahead
+    void prefetchAhead(Pixel px, Pixel lookahead) const {
+        Pixel ahead = {px.x + lookahead.x, px.y + lookahead.y};
+        if (ahead.inRange(W, H))
+            prefetch(ahead);
+    }
+
+    /// Get the center pixel of the frame (or of the region of interest).
+    Pixel center() const { return roi.center(); }
 
     /// Get the point of intersection of two lines.
+    /// @see    GRID_FINDER_FIXED_POINT_GEOMETRY
     static Point intersect(LineResult a, LineResult b) {
+#if GRID_FINDER_FIXED_POINT_GEOMETRY
+        optional<FixedPoint> point = FixedPointLine::intersect(
+            {a.lineCenter, a.angle}, {b.lineCenter, b.angle});
+        // Parallel lines intersect at infinity, like in the floating point
+        // version
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        return point ? point->toPoint() : Point{inf, inf};
+#else
         return Line::intersect(Line(a.lineCenter, a.angle),
                                Line(b.lineCenter, b.angle));
+#endif
     }
 
 #pragma endregion
 
 #pragma region Finding the first line...........................................
 
-    // TODO: can we make this dynamic?
-    /// The minimum width the first line must have.
-    constexpr static uint MINIMUM_START_LINE_WIDTH = 10;
-    /// The minimum number of Hough votes the first line must have.
-    /// @see    HoughResult::count
-    constexpr static uint MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT = (W + H) / 10;
-
     /**
      * @brief   Get an estimate of the line through a given pixel.
      *          Find an estimate of the slope, then use that to determine the 
@@ -516,35 +993,43 @@ class GridFinder {
      *          Find the line that goes through this point.
      * @return
      *          Returns no result if no line can be found that has a vote count 
-     *          higher than #MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT, or if the 
-     *          line candidate has a width that's less than 
-     *          #MINIMUM_START_LINE_WIDTH.  
+     *          higher than Parameters::MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT, 
+     *          or if the line candidate has a width that's less than 
+     *          Parameters::MINIMUM_START_LINE_WIDTH.  
      *          Also doesn't return an estimate if #getMiddleWithRetries fails.
      */
     optional<FirstLineEstimate> getFirstLineEstimate(Pixel point) const {
         // Find an estimate for the slope of the line.
         // Doesn't have to be accurate, just to find the width.
-        HoughResult firstResult = findLineAngle(point);
-        angle_t firstAngle      = firstResult.angle;
+        optional<HoughResult> firstResult = findLineAngle(point);
+        if (!firstResult.has_value())
+            return std::nullopt;
+        angle_t firstAngle = firstResult->angle;
 
         // There could be noise, so the first "line" could be just a white
         // bit of noise
-        if (firstResult.count < MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT)
+        if (firstResult->count <
+            scaleToRegion(params.MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT)) {
+            diagnose(DiagnosticEvent::LineRejectedVotes, point, firstAngle,
+                     firstResult->count);
             return std::nullopt;
+        }
 
         optional<GetMiddleResult> middle =
             getMiddleWithRetries(point, firstAngle);
 
-        if (!middle.has_value() || middle->width < MINIMUM_START_LINE_WIDTH)
+        if (!middle.has_value())
+            return std::nullopt;
+        if (middle->width < params.MINIMUM_START_LINE_WIDTH) {
+            diagnose(DiagnosticEvent::LineRejectedWidth, middle->pixel,
+                     firstAngle, middle->width);
             return std::nullopt;
+        }
 
-        return FirstLineEstimate{middle->pixel, middle->width, firstAngle};
+        return FirstLineEstimate{middle->pixel, middle->width, firstAngle,
+                                 middle->widthSpread};
     }
 
-    /// Don't use vertical lines as the first line, as this can result in
-    /// finding a first square that's not in the center of the frame.
-    constexpr static uint MAXIMUM_VERTICAL_START_LINE_WIDTH = 32;
-
     /**
      * @brief   Find the vertical range of white pixels closest to the center of
      *          the given column, then try to find an estimate of the line going
@@ -588,7 +1073,8 @@ class GridFinder {
      * sideways, to a different column, where it will find a horizontal line.
      * 
      * @param   x
-     *          The x-coordinate of the column to search in.
+     *          The x-coordinate of the column to search in. Only the part of
+     *          the column inside of the region of interest is searched.
      * @return  
      *          Returns no result if the vertical range of white pixels is too
      *          long, which would indicate a vertical line.  
@@ -596,31 +1082,40 @@ class GridFinder {
      *          white pixels are found in the given column.
      */
     optional<FirstLineEstimate> getFirstLineEstimate(uint x) const {
-        if (x >= W)
-            throw std::out_of_range("x out of range");
+        if (x - roi.x >= roi.width) {
+            fail(SearchStatus::OutOfRange, "x out of range");
+            return std::nullopt;
+        }
+
+        // The y-coordinates below are relative to the top of the region of
+        // interest.
+        const uint h = roi.height;
+        auto at      = [this, x](uint y) { return get(x, roi.y + y); };
 
         // Iterate like this: `... 6  4  2  0  1  3  5 ...` to find the pixels
         // close to the center first.
-        CenterPointOutLineIterator c = {H};
+        CenterPointOutLineIterator c = {h};
 
         // If the center pixel is white, look for the first black pixels in both
         // directions
-        if (get(x, c.getCenter())) {
-            uint first_white;
-            uint y = c.getCenter();
+        if (at(c.getCenter())) {
+            // The center pixel is white, so it's the first and last white
+            // pixel if its neighbors aren't.
+            uint first_white = c.getCenter();
+            uint y           = c.getCenter();
             // Find the lowest white pixel of the line through the center
-            while (y < H) {
-                if (get(x, y))
+            while (y < h) {
+                if (at(y))
                     first_white = y;
                 else
                     break;
                 --y;
             }
             // Find the highest white pixel of the line through the center
-            uint last_white;
-            y = c.getCenter();
-            while (y < H) {
-                if (get(x, y))
+            uint last_white = c.getCenter();
+            y               = c.getCenter();
+            while (y < h) {
+                if (at(y))
                     last_white = y;
                 else
                     break;
@@ -628,22 +1123,23 @@ class GridFinder {
             }
             y = (first_white + last_white) / 2;
             assert(last_white >= first_white);
-            if (last_white - first_white >= MAXIMUM_VERTICAL_START_LINE_WIDTH)
+            if (last_white - first_white >=
+                params.MAXIMUM_VERTICAL_START_LINE_WIDTH)
                 return std::nullopt;
             else
-                return getFirstLineEstimate({x, y});
+                return getFirstLineEstimate({x, roi.y + y});
         }
         // If the center pixel is not white, look for the first white pixel in
         // both directions
-        uint first_white = H;
+        uint first_white = h;
         while (c.hasNext()) {
             uint y = c.next();
-            if (get(x, y)) {
+            if (at(y)) {
                 first_white = y;
                 break;
             }
         }
-        if (first_white >= H)
+        if (first_white >= h)
             return std::nullopt;
 
         uint last_white = first_white;
@@ -651,8 +1147,8 @@ class GridFinder {
         if (first_white < c.getCenter()) {
             // Look downwards for the last white pixel of that line
             uint y = first_white;
-            while (y < H) {
-                if (get(x, y))
+            while (y < h) {
+                if (at(y))
                     last_white = y;
                 else
                     break;
@@ -660,17 +1156,18 @@ class GridFinder {
             }
             y = (first_white + last_white) / 2;
             assert(first_white >= last_white);
-            if (first_white - last_white >= MAXIMUM_VERTICAL_START_LINE_WIDTH)
+            if (first_white - last_white >=
+                params.MAXIMUM_VERTICAL_START_LINE_WIDTH)
                 return std::nullopt;
             else
-                return getFirstLineEstimate({x, y});
+                return getFirstLineEstimate({x, roi.y + y});
 
             // If the first white pixel is above the center
         } else {
             // Look upwards for the last white pixel of that line
             uint y = first_white;
-            while (y < H) {
-                if (get(x, y))
+            while (y < h) {
+                if (at(y))
                     last_white = y;
                 else
                     break;
@@ -678,30 +1175,28 @@ class GridFinder {
             }
             y = (first_white + last_white) / 2;
             assert(last_white >= first_white);
-            if (last_white - first_white >= MAXIMUM_VERTICAL_START_LINE_WIDTH)
+            if (last_white - first_white >=
+                params.MAXIMUM_VERTICAL_START_LINE_WIDTH)
                 return std::nullopt;
             else
-                return getFirstLineEstimate({x, y});
+                return getFirstLineEstimate({x, roi.y + y});
         }
     }
 
-    /// If no valid first line is found in a column, don't try the column right
-    /// next to it, but go a little farther.
-    constexpr static uint FIRST_LINE_INVALID_HORIZONTAL_JUMP = 10;
-
     /**
      * @brief   Get an estimate of the first line.
      *          Searches in multiple columns, starting from the center, taking
-     *          jumps of #FIRST_LINE_INVALID_HORIZONTAL_JUMP pixels if no valid
-     *          line is found in the currenc column.
+     *          jumps of Parameters::FIRST_LINE_INVALID_HORIZONTAL_JUMP pixels 
+     *          if no valid line is found in the currenc column.
      * 
      * @return  Returns no result if no valid lines are found across the entire
      *          frame.
      */
     optional<FirstLineEstimate> getFirstLineEstimate() const {
-        CenterPointOutLineIterator c = {W / FIRST_LINE_INVALID_HORIZONTAL_JUMP};
-        while (c.hasNext()) {
-            uint x = c.next() * FIRST_LINE_INVALID_HORIZONTAL_JUMP;
+        const uint jump = params.FIRST_LINE_INVALID_HORIZONTAL_JUMP;
+        CenterPointOutLineIterator c = {roi.width / jump};
+        while (c.hasNext() && !budget.exhausted()) {
+            uint x = roi.x + c.next() * jump;
             if (auto fle = getFirstLineEstimate(x); fle.has_value())
                 return fle;
         }
@@ -725,14 +1220,19 @@ class GridFinder {
         if (!start.has_value())
             return {std::nullopt, std::nullopt};
 
-        constexpr uint range = angle_t::resolution() / 40;  // 2 * 9°
-        HoughResult result1  = findLineAngleAccurateRange<range>(
-            start->middle, start->angleEstimate);
-        HoughResult result2 = findLineAngleAccurateRange<range>(
-            start->middle, start->angleEstimate.opposite());
+        const uint range = params.ACCURATE_ANGLE_RANGE;
+        // Half lines whose histogram is incomplete are dropped
+        auto halfLine = [&](angle_t angle) -> optional<LineResult> {
+            optional<HoughPeak> result =
+                findLineAngleAccurateRange(start->middle, angle, range);
+            if (!result.has_value())
+                return std::nullopt;
+            return makeLine(start->middle, start->width, start->widthSpread,
+                            *result, range);
+        };
         return {{
-            LineResult{start->middle, start->width, result1.angle},
-            LineResult{start->middle, start->width, result2.angle},
+            halfLine(start->angleEstimate),
+            halfLine(start->angleEstimate.opposite()),
         }};
     }
 
@@ -740,9 +1240,6 @@ class GridFinder {
 
 #pragma region Finding the next perpendicular line..............................
 
-    /// Perpendicular lines have to be long enough to be counted as a real line.
-    constexpr static uint MINIMIM_LINE_WEIGHTED_VOTE_COUNT = (W + H) / 10;
-
     /**
      * @brief   Follow the given line to find the line perpendicular to it.
      *          Move along the line for @p minDistance pixels, then move away
@@ -786,18 +1283,22 @@ class GridFinder {
 
         uint minWidth = line.width / 3;
 
-        BresenhamLine path = {searchStart, angle, W, H};
+        BresenhamLine path = {searchStart, angle, roi};
+        // The start falls outside of the region of interest if #move ran off
+        // of it (it then returns an invalid pixel)
+        if (!path.hasNext())
+            return std::nullopt;
         Pixel pixel;
         do {
             // Follow the search path
-            pixel = path.next();
+            pixel = nextPixel(path);
             // Find the first white pixel
             while (path.hasNext() && get(pixel) == 0x00)
-                pixel = path.next();
+                pixel = nextPixel(path);
             Pixel firstWhite = pixel;
             // Find the first black pixel
             while (path.hasNext() && get(pixel) != 0x00)
-                pixel = path.next();
+                pixel = nextPixel(path);
             Pixel firstBlack = pixel;  // TODO: OBOE, but I don't really care
             // In the center of this range of white pixels, try to find the
             // perpendicular line
@@ -808,7 +1309,8 @@ class GridFinder {
             if (possibleLine)
                 return possibleLine;
             // Otherwise, keep looking along the search path
-        } while (path.hasNext());
+        } while (path.hasNext() && !budget.exhausted());
+        budget.charge(path.getCurrentLength());
         // If we reach the end of the frame without finding a perpendicular line
         // return no result, so the calling function can call again with a
         // different offset (or give up)
@@ -842,18 +1344,143 @@ class GridFinder {
     optional<LineResult> checkLine(Pixel pixel, angle_t angle,
                                    uint minWidth) const {
         optional<GetMiddleResult> middle = getMiddle(pixel, angle);
-        if (!middle.has_value() || middle->width <= minWidth)
+        if (!middle.has_value())
             return std::nullopt;
+        if (middle->width <= minWidth) {
+            diagnose(DiagnosticEvent::LineRejectedWidth, middle->pixel, angle,
+                     middle->width);
+            return std::nullopt;
+        }
 
-        constexpr uint range = angle_t::resolution() / 40;  // 2 * 9°
-        HoughResult result =
-            findLineAngleAccurateRange<range>(middle->pixel, angle);
+        const uint range = params.ACCURATE_ANGLE_RANGE;
+        optional<HoughPeak> result =
+            findLineAngleAccurateRange(middle->pixel, angle, range);
+        // Don't accept lines with an incomplete histogram
+        if (!result.has_value())
+            return std::nullopt;
 
-        if (result.count < MINIMIM_LINE_WEIGHTED_VOTE_COUNT)
+        if (result->count <
+            scaleToRegion(params.MINIMIM_LINE_WEIGHTED_VOTE_COUNT)) {
+            diagnose(DiagnosticEvent::LineRejectedVotes, middle->pixel,
+                     result->angle, result->count);
             return std::nullopt;
-        return LineResult{middle->pixel, middle->width, result.angle};
+        }
+        return makeLine(middle->pixel, middle->width, middle->widthSpread,
+                        *result, range);
+    }
+
+#pragma endregion
+
+#pragma region Confidence.......................................................
+
+    /**
+     * @brief   Get the confidence of a line, between 0 and 1. It only uses
+     *          data that was already collected while finding the line, it
+     *          doesn't look at the mask again. It is the product of three
+     *          factors:
+     * 
+     *            - The vote count, relative to 
+     *              Parameters::MINIMIM_LINE_WEIGHTED_VOTE_COUNT: ½ at the
+     *              threshold, 1 at twice the threshold or more.
+     *            - The sharpness of the peak of #findLineAngleAccurateRange:
+     *              1 if only one angle has the maximum count, 0 if all 
+     *              angles in the range do.
+     *            - The consistency of the width: 1 if the widths on both sides
+     *              of the middle are equal, 0 if they differ by the full width
+     *              of the line.
+     * 
+     * @param   peak
+     *          The result of #findLineAngleAccurateRange.
+     * @param   range
+     *          The number of angles @p N passed to 
+     *          #findLineAngleAccurateRange.
+     * @param   middle
+     *          The result of #getMiddle.
+     */
+    float lineConfidence(HoughPeak peak, uint range,
+                         GetMiddleResult middle) const {
+        const float minVotes =
+            scaleToRegion(params.MINIMIM_LINE_WEIGHTED_VOTE_COUNT);
+        float votes = minVotes > 0 ? std::min(1.f, peak.count / (2 * minVotes))
+                                   : 1.f;
+        float sharpness =
+            range > 0 ? 1 - float(peak.width - 1) / (2 * range) : 1.f;
+        float consistency =
+            1 - std::min(1.f, float(middle.widthSpread) /
+                                  std::max(middle.width, 1u));
+        return votes * sharpness * consistency;
+    }
+
+    /// Create a LineResult with its vote count and confidence.
+    LineResult makeLine(Pixel center, uint width, uint widthSpread,
+                        HoughPeak peak, uint range) const {
+        float confidence =
+            lineConfidence(peak, range, {center, width, widthSpread});
+        return {center, width, peak.angle, peak.count, confidence};
+    }
+
+    /**
+     * @brief   Get the confidence of the intersection of two lines: the
+     *          product of the confidences of the lines and the sine of the
+     *          angle between them, because the intersection of lines that
+     *          are almost parallel is very sensitive to errors in the angles.
+     */
+    static float cornerConfidence(LineResult a, LineResult b) {
+        float sine = a.angle.cosf() * b.angle.sinf() - //
+                     a.angle.sinf() * b.angle.cosf();
+        return a.confidence * b.confidence * std::abs(sine);
+    }
+
+#pragma endregion
+
+#pragma region Rejecting hopeless frames........................................
+
+    /// The type of the summary of the white pixels of the mask.
+    using Occupancy_t = OccupancyMap<W, H>;
+
+    /**
+     * @brief   Check whether the region of interest could contain a square at
+     *          all, using only the #Occupancy_t map that was built when the
+     *          mask was loaded (a few hundred counters, no pixel accesses).
+     * 
+     * The frame is rejected if it has fewer than 
+     * Parameters::MINIMUM_WHITE_PIXELS white pixels, if more than 
+     * Parameters::MAXIMUM_WHITE_PERCENTAGE percent of its pixels are white,
+     * or if all white pixels lie in an area that's too small for a line with
+     * Parameters::MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT votes (the votes of
+     * a ray are its length, so the white pixels of such a line span at least
+     * 1/√2 of that in either the horizontal or the vertical direction).
+     * The thresholds are scaled to the region of interest.
+     * 
+     * The map counts the pixels of the input mask. If the storage presents
+     * them in other coordinates (`Storage::REMAPS`, e.g. UndistortedStorage),
+     * the region of interest doesn't correspond to the cells of the map, so
+     * the entire frame is checked instead.
+     * 
+     * @return  SearchStatus::Ok if the frame should be searched, or the
+     *          reason why it's rejected.
+     */
+    SearchStatus checkFrame() const {
+        const Rect region = Storage::REMAPS ? Rect{0, 0, W, H} : roi;
+        auto scale        = [&](uint count) {
+            return Storage::REMAPS ? count : scaleToRegion(count);
+        };
+        const OccupancySummary s = occupancy.summarize(region);
+        if (s.white < scale(params.MINIMUM_WHITE_PIXELS))
+            return SearchStatus::TooFewPixels;
+        const size_t white = s.white, area = s.area;
+        if (100 * white > params.MAXIMUM_WHITE_PERCENTAGE * area)
+            return SearchStatus::TooManyPixels;
+        const uint votes =
+            scale(params.MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT);
+        if (std::max(s.extentX, s.extentY) < votes * 7 / 10)  // 1/√2
+            return SearchStatus::NoStructure;
+        return SearchStatus::Ok;
     }
 
+    /// Get the summary of the white pixels of the mask.
+    const Occupancy_t &getOccupancy() const { return occupancy; }
+
 #pragma endregion
 
 #pragma region Finding the center square(main function).........................
@@ -866,10 +1493,42 @@ class GridFinder {
      * 
      * @return  // TODO 
      */
-    Square findSquare() {
-        Square sq;
+    Square findSquare() { return findSquare(SearchBudget()); }
 
+    /**
+     * @brief   Same as #findSquare(), but stops searching when the given
+     *          budget is used up, which bounds the worst-case latency.
+     * 
+     * @return  The lines and points that were found before the budget ran 
+     *          out. Square::truncated is set if the search was cut short.
+     *          Frames that are rejected by #checkFrame return an empty square
+     *          immediately, with the reason in Square::status.
+     */
+    Square findSquare(SearchBudget limit) {
+        Square sq;
+        if (parameterStatus != SearchStatus::Ok) {
+            sq.status = parameterStatus;
+            return sq;
+        }
+        // Don't bother searching frames that can't contain a square
+        if (SearchStatus status = checkFrame(); status != SearchStatus::Ok) {
+            diagnose(DiagnosticEvent::FrameRejected, center(), angle_t(),
+                     uint(status));
+            sq.status     = status;
+            lastStepCount = 0;
+            houghCache.resetStats();
+            return sq;
+        }
+        // All temporaries of the previous frame can be discarded
+        scratch.reset();
+        houghCache.clear();
+        houghCache.resetStats();
+        budget       = limit;
+        searchStatus = SearchStatus::Ok;
+
+#if GRID_FINDER_EXCEPTIONS
         try {
+#endif
             // Get the line closest to the center of the frame.
             // the result is an array of two half-lines, approximately opposite
             // of each other
@@ -883,8 +1542,13 @@ class GridFinder {
             // center point (if possible)
             bool direction = false;
             if (sq.lines[0].has_value()) {
+#if GRID_FINDER_FIXED_POINT_GEOMETRY
+                FixedPointLine mathLine = {sq.lines[0]->lineCenter,
+                                           sq.lines[0]->angle};
+#else
                 Line mathLine = {sq.lines[0]->lineCenter, sq.lines[0]->angle};
-                direction     = mathLine.leftOfPoint(center());
+#endif
+                direction = mathLine.leftOfPoint(center());
             }
 
             // Find the two lines perpendicular to the first half lines
@@ -896,6 +1560,10 @@ class GridFinder {
             if (sq.lines[2].has_value() && sq.lines[3].has_value()) {
                 sq.points[0] = intersect(*sq.lines[0], *sq.lines[2]);
                 sq.points[1] = intersect(*sq.lines[1], *sq.lines[3]);
+                sq.pointConfidence[0] =
+                    cornerConfidence(*sq.lines[0], *sq.lines[2]);
+                sq.pointConfidence[1] =
+                    cornerConfidence(*sq.lines[1], *sq.lines[3]);
 
                 // Calculate the distance between the first two points
                 // (note that this is not the Euclidian distance, but the
@@ -914,7 +1582,9 @@ class GridFinder {
                     std::max(sq.lines[2]->width, sq.lines[3]->width);
 
                 // Search for the fourth line
-                while (!sq.lines[4].has_value() && offset < maxOffset) {
+                uint attempts = 0;
+                while (!sq.lines[4].has_value() && offset < maxOffset &&
+                       !budget.exhausted()) {
                     sq.lines[4] =  // find the fourth line along the second
                         findNextLine(sq.lines[2], direction, minDistance,
                                      offset);
@@ -924,11 +1594,21 @@ class GridFinder {
                                          offset);
                     // next time, try again with a different offset
                     offset += offsetIncr;
+                    ++attempts;
                 }
                 // If we found a fourth line, calculate the intersections
                 if (sq.lines[4].has_value()) {
                     sq.points[2] = intersect(*sq.lines[2], *sq.lines[4]);
                     sq.points[3] = intersect(*sq.lines[3], *sq.lines[4]);
+                    sq.pointConfidence[2] =
+                        cornerConfidence(*sq.lines[2], *sq.lines[4]);
+                    sq.pointConfidence[3] =
+                        cornerConfidence(*sq.lines[3], *sq.lines[4]);
+                    sq.homography = squareHomography(sq);
+                } else if (offset >= maxOffset) {
+                    diagnose(DiagnosticEvent::RetriesExhausted,
+                             sq.lines[2]->lineCenter, sq.lines[2]->angle,
+                             attempts);
                 }
             } else if (sq.lines[2].has_value()) {
                 // TODO
@@ -937,15 +1617,144 @@ class GridFinder {
             } else {
                 // TODO
             }
+#if GRID_FINDER_EXCEPTIONS
+        } catch (std::invalid_argument &e) {
+            report(SearchStatus::InvalidArgument, e.what());
+        } catch (std::out_of_range &e) {
+            report(SearchStatus::OutOfRange, e.what());
+        } catch (std::bad_alloc &e) {
+            report(SearchStatus::OutOfMemory, e.what());
         } catch (std::exception &e) {
-            cerr << ANSIColors::redb << e.what() << ANSIColors::reset << endl;
+            report(SearchStatus::Error, e.what());
         }
+#endif
+        sq.status = searchStatus;
+        if (sq.status == SearchStatus::Ok && budget.wasCancelled())
+            sq.status = SearchStatus::Cancelled;
+        // Errors also exhaust the budget, but they're reported separately
+        sq.truncated  = sq.status == SearchStatus::Ok && budget.wasExhausted();
+        lastStepCount = budget.getStepCount();
+        // Don't limit any functions that are called outside of findSquare
+        budget = SearchBudget();
         return sq;
     }
 
+    /// Get the number of Bresenham steps used by the last #findSquare call.
+    size_t getStepCount() const { return lastStepCount; }
+
+    /**
+     * @brief   Limit the work of the functions that are called outside of
+     *          #findSquare, e.g. when PyramidGridFinder refines its lines on
+     *          the full resolution mask. The budget applies until it's
+     *          replaced, or until the next call to #findSquare.
+     */
+    void setBudget(SearchBudget limit) { budget = limit; }
+    /// Get the budget set by #setBudget, with the steps used so far.
+    SearchBudget &getBudget() { return budget; }
+
+    /**
+     * @brief   Compute the homography that maps the corners of the square to
+     *          grid coordinates.
+     *
+     * The first two points lie on the first line (the u axis), and the other
+     * two points lie on the fourth line, one grid cell further along the v
+     * axis. Depending on the direction the search turned in, the grid
+     * coordinates can be mirrored compared to the image.
+     *
+     * @return  The homography, or nothing if not all points were found, or if
+     *          they are degenerate (three of them on a line).
+     */
+    static std::optional<Homography> squareHomography(const Square &sq) {
+        constexpr Point grid[4] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+        std::array<PointPair, 4> pairs;
+        for (size_t i = 0; i < 4; ++i) {
+            if (!sq.points[i])
+                return std::nullopt;
+            pairs[i] = {*sq.points[i], grid[i]};
+        }
+        return Homography::fit(pairs);
+    }
+
 #pragma endregion
 
   private:
-    /// The matrix containing the mask values.
-    Img_t mask;
+    /**
+     * @brief   Report an error: throw the exception that corresponds to the
+     *          status, or, without exceptions, record the status and cancel
+     *          the rest of the search (until the next call to #findSquare).
+     */
+    void fail(SearchStatus status, const char *message) const {
+#if GRID_FINDER_EXCEPTIONS
+        switch (status) {
+            case SearchStatus::InvalidArgument:
+                throw std::invalid_argument(message);
+            case SearchStatus::OutOfRange: throw std::out_of_range(message);
+            default: throw std::runtime_error(message);
+        }
+#else
+        report(status, message);
+#endif
+    }
+
+    /**
+     * @brief   Get the next pixel of a path, or fail with
+     *          SearchStatus::OutOfRange if there is none.
+     *
+     * With exceptions, BresenhamLine::next throws `std::out_of_range` itself.
+     * Without exceptions, it can't report anything, so the failure is
+     * reported here instead, and a pixel inside of the region of interest is
+     * returned, so the caller never reads outside of the mask.
+     */
+    Pixel nextPixel(BresenhamLine &path) const {
+        if (!path.hasNext()) {
+            fail(SearchStatus::OutOfRange,
+                 "Error: No more pixels on line within canvas!");
+            return {roi.x, roi.y};
+        }
+        return path.next();
+    }
+
+    /// Record the first error of the current search and cancel the rest of
+    /// it. The message is not stored, the status and a diagnostic event are.
+    void report(SearchStatus status, const char *message) const {
+        (void) message;
+        diagnose(DiagnosticEvent::Error, Pixel(), angle_t(), uint(status));
+        if (searchStatus == SearchStatus::Ok)
+            searchStatus = status;
+        budget.cancel();
+    }
+
+    /// Record a diagnostic event. Never blocks, events are dropped if nobody
+    /// drains them.
+    void diagnose(DiagnosticEvent event, Pixel pixel, angle_t angle,
+                  uint value) const {
+        diagnostics.push({event, pixel, angle, value});
+    }
+
+    /// The mask values.
+    Storage mask;
+    /// The number of white pixels in each cell of the mask, for #checkFrame.
+    Occupancy_t occupancy;
+    /// The detection thresholds.
+    Parameters params;
+    /// Memory for temporary data (vote histograms etc.) that's only needed
+    /// while searching the current frame. Reset at the start of each frame.
+    /// It's mutable because it doesn't affect the observable state.
+    mutable Scratch_t scratch;
+    /// The region of the mask to search in.
+    Rect roi = {0, 0, W, H};
+    /// The Hough results of the current frame. Mutable for the same reason as
+    /// #scratch.
+    mutable HoughCache_t houghCache;
+    /// The amount of work the current search is still allowed to do.
+    mutable SearchBudget budget;
+    /// The number of steps used by the last call to #findSquare.
+    size_t lastStepCount = 0;
+    /// Whether the current parameters are valid (only used without
+    /// exceptions, otherwise invalid parameters are never accepted).
+    SearchStatus parameterStatus = SearchStatus::Ok;
+    /// The first error of the current search.
+    mutable SearchStatus searchStatus = SearchStatus::Ok;
+    /// Diagnostic events. Mutable for the same reason as #scratch.
+    mutable Diagnostics_t diagnostics;
 };
@@ -1,6 +1,9 @@
 #include <Angle.hpp>
+#include <Config.hpp>
+#include <Homography.hpp>
 #include <Line.hpp>
 #include <Pixel.hpp>
+#include <cstdint>
 #include <optional>
 
 #pragma region Structs..........................................................
@@ -17,31 +20,102 @@ struct HoughResult {
     bool operator<(HoughResult other) const { return count < other.count; }
 };
 
+/**
+ * @brief   Result of GridFinder::findLineAngleAccurateRange: the angle and
+ *          vote count of the peak, and how wide the peak is.
+ */
+struct HoughPeak : HoughResult {
+    /// The number of angles around the peak with at least ⅞ of the maximum
+    /// vote count. Sharp peaks (narrow, clean lines) have a small width.
+    uint width;
+};
+
 struct LineResult {
     Pixel lineCenter;
     uint width;
     angle_t angle;
+    /// The weighted vote count of the line.
+    uint votes = 0;
+    /// How likely it is that this is an actual line of the grid, between 0
+    /// and 1. See GridFinder::lineConfidence.
+    float confidence = 0;
 };
 
 struct FirstLineEstimate {
     Pixel middle;
     uint width;
     angle_t angleEstimate;
+    /// See GetMiddleResult::widthSpread.
+    uint widthSpread = 0;
 };
 
 struct GetMiddleResult {
     Pixel pixel;
     uint width;
+    /// The difference between the widths measured on both sides of the
+    /// point along the line. Zero if the edges of the line are parallel.
+    uint widthSpread = 0;
+};
+
+/**
+ * @brief   The reason why a search failed.
+ *
+ * When exceptions are enabled, GridFinder::findSquare catches them and sets
+ * the corresponding status. When they're disabled (see Config.hpp), the error
+ * is recorded directly, and the rest of the search is cancelled.
+ * Frames that are rejected by GridFinder::checkFrame are not searched at all.
+ */
+enum class SearchStatus : uint8_t {
+    Ok = 0,             ///< The search completed (possibly #Square::truncated).
+    InvalidParameters,  ///< The parameters were rejected by checkParameters.
+    InvalidArgument,    ///< An internal function got inconsistent arguments.
+    OutOfRange,         ///< A ray or an angle range left its valid domain.
+    OutOfMemory,        ///< The scratch memory was too small.
+    Error,              ///< Any other error.
+    TooFewPixels,       ///< Rejected: too few white pixels (too dark).
+    TooManyPixels,      ///< Rejected: too many white pixels (overexposed).
+    NoStructure,        ///< Rejected: the white pixels are too concentrated.
+    Cancelled,          ///< Stopped by SearchBudget::cancelWhen.
 };
 
+/// Get a short description of the status, without the need for iostreams.
+constexpr const char *toString(SearchStatus status) {
+    switch (status) {
+        case SearchStatus::Ok: return "Ok";
+        case SearchStatus::InvalidParameters: return "Invalid parameters";
+        case SearchStatus::InvalidArgument: return "Invalid argument";
+        case SearchStatus::OutOfRange: return "Out of range";
+        case SearchStatus::OutOfMemory: return "Out of memory";
+        case SearchStatus::TooFewPixels: return "Too few pixels";
+        case SearchStatus::TooManyPixels: return "Too many pixels";
+        case SearchStatus::NoStructure: return "No structure";
+        case SearchStatus::Cancelled: return "Cancelled";
+        default: return "Error";
+    }
+}
+
 struct Square {
     std::array<std::optional<LineResult>, 5> lines;
     std::array<std::optional<Point>, 4> points;
+    /// The confidence of each of the #points, between 0 and 1, or 0 if the
+    /// point wasn't found. See GridFinder::cornerConfidence.
+    std::array<float, 4> pointConfidence = {};
+    /// Set if the search was cut short because its budget ran out.
+    /// @see    GridFinder::findSquare(SearchBudget)
+    bool truncated = false;
+    /// Whether the search succeeded, and if not, why it failed.
+    SearchStatus status = SearchStatus::Ok;
+    /// The mapping from the image to the grid, if all four #points were
+    /// found. The corners are mapped to (0, 0), (1, 0), (0, 1) and (1, 1)
+    /// respectively. See GridFinder::squareHomography.
+    std::optional<Homography> homography;
 };
 
 #pragma endregion
 #pragma region Printing.........................................................
 
+#if GRID_FINDER_IOSTREAM
+
 /**
  * @brief   Function for printing a HoughResult.
  * @see     HoughResult
@@ -66,4 +140,6 @@ inline std::ostream &operator<<(std::ostream &os, const Square &sq) {
     return os << ']';
 }
 
+#endif
+
 #pragma endregion
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <Line.hpp>
+#include <Matrix.hpp>
+#include <Span.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <utility>  // swap
+#include <uint.hpp>
+
+/// A point in the image, and the point of the grid that it's an image of.
+struct PointPair {
+    Point image;
+    Point grid;
+};
+
+/**
+ * @brief   A projective mapping from image coordinates to grid coordinates.
+ *
+ * The grid coordinates are in units of grid cells, so the intersections of
+ * the grid lines have integer coordinates. Combined with the camera
+ * calibration, this is all that's needed to compute the pose of the camera
+ * relative to the grid.
+ *
+ * #fit uses the direct linear transform (DLT) with @f$ h_{33} = 1 @f$: every
+ * correspondence contributes two rows to an 8-column linear system, which is
+ * solved in the least-squares sense through its 8×8 normal equations. All
+ * matrices have a fixed size, so there are no allocations, and the time only
+ * grows linearly with the number of points. The points are normalized first
+ * (centered, and scaled to an average distance of √2), so single precision is
+ * accurate enough.
+ */
+struct Homography {
+    /// The 3×3 matrix that maps homogeneous image coordinates to homogeneous
+    /// grid coordinates, scaled such that the bottom-right element is 1.
+    TMatrix<float, 3, 3> matrix;
+
+    /// Map a point in the image to grid coordinates.
+    Point map(Point p) const {
+        const auto &h = matrix;
+        float w       = h[2][0] * p.x + h[2][1] * p.y + h[2][2];
+        return {(h[0][0] * p.x + h[0][1] * p.y + h[0][2]) / w,
+                (h[1][0] * p.x + h[1][1] * p.y + h[1][2]) / w};
+    }
+
+    /**
+     * @brief   Find the homography that best maps the image points to the grid
+     *          points.
+     *
+     * @param   pairs
+     *          At least four correspondences, no three of which are collinear.
+     *          With exactly four, the mapping is exact.
+     * @return  The homography, or nothing if there are too few points, or if
+     *          they are degenerate.
+     */
+    static std::optional<Homography> fit(Span<const PointPair> pairs) {
+        if (pairs.size() < 4)
+            return std::nullopt;
+        const Normalization image = normalization(pairs, &PointPair::image);
+        const Normalization grid  = normalization(pairs, &PointPair::grid);
+        if (image.scale == 0 || grid.scale == 0)
+            return std::nullopt;
+
+        // The normal equations AᵀA h = Aᵀb, augmented with Aᵀb
+        TMatrix<float, 8, 9> system{};
+        for (const PointPair &pair : pairs) {
+            const Point p = image(pair.image), q = grid(pair.grid);
+            const float rows[2][9] = {
+                {p.x, p.y, 1, 0, 0, 0, -q.x * p.x, -q.x * p.y, q.x},
+                {0, 0, 0, p.x, p.y, 1, -q.y * p.x, -q.y * p.y, q.y},
+            };
+            for (const auto &a : rows)
+                for (uint i = 0; i < 8; ++i)
+                    for (uint j = 0; j < 9; ++j)
+                        system[i][j] += a[i] * a[j];
+        }
+        std::optional<std::array<float, 8>> h = solve(system);
+        if (!h)
+            return std::nullopt;
+
+        // Undo the normalization: H = T_grid⁻¹ H_n T_image
+        const float n[3][3] = {
+            {(*h)[0], (*h)[1], (*h)[2]},
+            {(*h)[3], (*h)[4], (*h)[5]},
+            {(*h)[6], (*h)[7], 1},
+        };
+        float nt[3][3];  // H_n T_image
+        for (uint r = 0; r < 3; ++r) {
+            nt[r][0] = n[r][0] * image.scale;
+            nt[r][1] = n[r][1] * image.scale;
+            nt[r][2] = n[r][2] - n[r][0] * image.scale * image.center.x -
+                       n[r][1] * image.scale * image.center.y;
+        }
+        Homography result;
+        auto &m = result.matrix;
+        for (uint c = 0; c < 3; ++c) {
+            m[0][c] = nt[0][c] / grid.scale + grid.center.x * nt[2][c];
+            m[1][c] = nt[1][c] / grid.scale + grid.center.y * nt[2][c];
+            m[2][c] = nt[2][c];
+        }
+        const float w = m[2][2];
+        if (std::abs(w) < EPSILON)
+            return std::nullopt;
+        for (uint r = 0; r < 3; ++r)
+            for (uint c = 0; c < 3; ++c)
+                m[r][c] /= w;
+        return result;
+    }
+
+  private:
+    /// Pivots smaller than this (after normalization) mean the points are
+    /// degenerate.
+    constexpr static float EPSILON = 1e-6f;
+    constexpr static float SQRT2   = 1.41421356f;
+
+    /// Moves the centroid of a set of points to the origin, and scales them
+    /// to an average distance of √2.
+    struct Normalization {
+        Point center;
+        float scale;
+
+        Point operator()(Point p) const {
+            return {(p.x - center.x) * scale, (p.y - center.y) * scale};
+        }
+    };
+
+    static Normalization normalization(Span<const PointPair> pairs,
+                                       Point PointPair::*member) {
+        Point center = {0, 0};
+        for (const PointPair &pair : pairs) {
+            center.x += (pair.*member).x;
+            center.y += (pair.*member).y;
+        }
+        center.x /= pairs.size();
+        center.y /= pairs.size();
+        float distance = 0;
+        for (const PointPair &pair : pairs)
+            distance += std::hypot((pair.*member).x - center.x,
+                                   (pair.*member).y - center.y);
+        distance /= pairs.size();
+        return {center, distance > 0 ? SQRT2 / distance : 0};
+    }
+
+    /// Solve the augmented 8×9 system by Gaussian elimination with partial
+    /// pivoting.
+    static std::optional<std::array<float, 8>>
+    solve(TMatrix<float, 8, 9> &m) {
+        for (uint col = 0; col < 8; ++col) {
+            uint pivot = col;
+            for (uint r = col + 1; r < 8; ++r)
+                if (std::abs(m[r][col]) > std::abs(m[pivot][col]))
+                    pivot = r;
+            if (std::abs(m[pivot][col]) < EPSILON)
+                return std::nullopt;
+            if (pivot != col)
+                for (uint c = 0; c < 9; ++c)
+                    std::swap(m[pivot][c], m[col][c]);
+            for (uint r = col + 1; r < 8; ++r) {
+                const float f = m[r][col] / m[col][col];
+                for (uint c = col; c < 9; ++c)
+                    m[r][c] -= f * m[col][c];
+            }
+        }
+        std::array<float, 8> x;
+        for (uint r = 8; r-- > 0;) {
+            float sum = m[r][8];
+            for (uint c = r + 1; c < 8; ++c)
+                sum -= m[r][c] * x[c];
+            x[r] = sum / m[r][r];
+        }
+        return x;
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Pixel.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <uint.hpp>
+
+/**
+ * @brief   A fixed-size memo of Hough vote counts, keyed by the starting pixel
+ *          and the angle index of the ray.
+ *
+ * The table uses open addressing with linear probing. Every entry is stamped
+ * with the generation it was written in, so the entire cache can be cleared
+ * in constant time by incrementing the generation. When all slots of a probe
+ * sequence are taken, the first slot of the probe sequence is overwritten, so
+ * the memory use is bounded and the cache never allocates.
+ *
+ * @tparam  Capacity
+ *          The number of entries, must be a power of two.
+ */
+template <size_t Capacity>
+class HoughCache {
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+  public:
+    /// The maximum number of slots that are checked for a key.
+    constexpr static uint MAX_PROBES = 8;
+
+    /// The number of lookups that were or weren't found in the cache.
+    struct Stats {
+        size_t hits   = 0;
+        size_t misses = 0;
+        /// The fraction of lookups that were found in the cache.
+        double hitRate() const {
+            return hits + misses == 0 ? 0 : double(hits) / (hits + misses);
+        }
+    };
+
+    /**
+     * @brief   Look up the vote count of the given ray.
+     *
+     * @return  True if the count was found, in which case it's written to
+     *          @p count.
+     */
+    bool lookup(Pixel px, uint angleIndex, uint &count) {
+        uint64_t k = key(px, angleIndex);
+        for (uint i = 0, s = slot(k); i < MAX_PROBES; ++i, s = next(s)) {
+            const Entry &e = entries[s];
+            if (e.generation != generation)
+                break;
+            if (e.key == k) {
+                count = e.count;
+                ++stats.hits;
+                return true;
+            }
+        }
+        ++stats.misses;
+        return false;
+    }
+
+    /// Save the vote count of the given ray.
+    void insert(Pixel px, uint angleIndex, uint count) {
+        uint64_t k = key(px, angleIndex);
+        uint s     = slot(k);
+        for (uint i = 0; i < MAX_PROBES; ++i, s = next(s)) {
+            Entry &e = entries[s];
+            if (e.generation != generation || e.key == k) {
+                e = {k, count, generation};
+                return;
+            }
+        }
+        // All slots are in use, replace the first one
+        entries[slot(k)] = {k, count, generation};
+    }
+
+    /// Invalidate all entries.
+    void clear() {
+        if (++generation == 0) {
+            // The generation wrapped around, old entries could become valid
+            entries    = {};
+            generation = 1;
+        }
+    }
+
+    /// Get the hit and miss counts since the last #resetStats.
+    Stats getStats() const { return stats; }
+    /// Reset the hit and miss counts.
+    void resetStats() { stats = {}; }
+
+  private:
+    struct Entry {
+        uint64_t key        = 0;
+        uint32_t count      = 0;
+        uint32_t generation = 0;
+    };
+
+    static uint64_t key(Pixel px, uint angleIndex) {
+        return uint64_t(px.x) << 40 | uint64_t(px.y) << 16 | angleIndex;
+    }
+    static uint slot(uint64_t key) {
+        // Fibonacci hashing
+        return (key * 0x9E3779B97F4A7C15ull) >> 32 & (Capacity - 1);
+    }
+    static uint next(uint slot) { return (slot + 1) & (Capacity - 1); }
+
+    std::array<Entry, Capacity> entries = {};
+    /// Entries with a different generation are empty. Starts at one, so the
+    /// zero-initialized entries are empty.
+    uint32_t generation = 1;
+    Stats stats;
+};
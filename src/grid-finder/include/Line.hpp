@@ -1,9 +1,12 @@
 #pragma once
 
 #include <Angle.hpp>
+#include <Config.hpp>
 #include <Matrix.hpp>
 #include <Pixel.hpp>
+#if GRID_FINDER_IOSTREAM
 #include <ostream>
+#endif
 
 struct Point {
     float x;
@@ -14,6 +17,7 @@ struct Point {
     }
 };
 
+#if GRID_FINDER_IOSTREAM
 inline std::ostream &operator<<(std::ostream &os, Point p) {
     return os << '(' << p.x << ", " << p.y << ')';
 }
@@ -22,6 +26,7 @@ inline std::ostream &operator<<(std::ostream &os, Point p) {
 
 using std::cout;
 using std::endl;
+#endif
 
 class Line {
     using ColVec3f = TColVector<float, 3>;
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Matrix.hpp>
+#include <Pixel.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <uint.hpp>
+
+/**
+ * @file
+ *
+ * The memory layouts of the mask inside of GridFinder.
+ *
+ * GridFinder copies the mask into an object of its `Storage` type, and only
+ * accesses it through `get`, `set`, `address` and `source`. Storages that
+ * present the pixels in other coordinates than those of the input mask set
+ * `REMAPS`. The layout determines which
+ * pixels share a cache line: #RowMajorStorage keeps the layout of the input
+ * matrix, so horizontal rays are cheap, but vertical rays touch a new cache
+ * line on every step. #TiledStorage stores the mask as small square tiles, so
+ * the locality is roughly the same in all directions.
+ *
+ * UndistortedStorage (see UndistortedStorage.hpp) wraps one of these layouts,
+ * and corrects the lens distortion of the pixels as they are read.
+ */
+
+/**
+ * @brief   Stores the mask row by row, like the input matrix.
+ *
+ * @tparam  W
+ *          The width of the image in pixels.
+ * @tparam  H
+ *          The height of the image in pixels.
+ */
+template <size_t W, size_t H>
+class RowMajorStorage {
+  public:
+    /// The type of the image mask.
+    using Img_t = TMatrix<uint8_t, H, W>;
+
+    /// Create a mask of all zeros.
+    RowMajorStorage() : mask{} {}
+    /// Copy the given mask.
+    explicit RowMajorStorage(const Img_t &mask) : mask(mask) {}
+
+    /// Get the value of the given pixel.
+    constexpr uint8_t get(uint x, uint y) const { return mask[y][x]; }
+    /// Set the value of the given pixel.
+    void set(uint x, uint y, uint8_t value) { mask[y][x] = value; }
+    /// Get the address of the given pixel (for prefetching).
+    const uint8_t *address(uint x, uint y) const { return &mask[y][x]; }
+    /// Get the pixel of the input mask that's stored at the given pixel.
+    constexpr static Pixel source(uint x, uint y) { return {x, y}; }
+
+    /// The coordinates are those of the input mask.
+    constexpr static bool REMAPS = false;
+
+  private:
+    Img_t mask;
+};
+
+/**
+ * @brief   Stores the mask as square tiles of Tile×Tile pixels. The pixels
+ *          within a tile are stored row by row, and the tiles are stored row
+ *          by row as well.
+ *
+ * With the default 8×8 tiles, every tile is exactly one 64-byte cache line,
+ * so a ray in any direction visits a new cache line only every eight steps.
+ * The image is padded with zeros to a whole number of tiles.
+ *
+ * @tparam  W
+ *          The width of the image in pixels.
+ * @tparam  H
+ *          The height of the image in pixels.
+ * @tparam  Tile
+ *          The side of a tile in pixels, must be a power of two.
+ */
+template <size_t W, size_t H, uint Tile = 8>
+class TiledStorage {
+    static_assert(Tile > 0 && (Tile & (Tile - 1)) == 0,
+                  "Tile must be a power of two");
+
+  public:
+    /// The type of the image mask.
+    using Img_t = TMatrix<uint8_t, H, W>;
+
+    /// The number of tiles in a row of tiles.
+    constexpr static size_t TILES_X = (W + Tile - 1) / Tile;
+    /// The number of rows of tiles.
+    constexpr static size_t TILES_Y = (H + Tile - 1) / Tile;
+
+    /// Create a mask of all zeros.
+    TiledStorage() : data{} {}
+    /// Copy the given mask, converting it to tiles.
+    explicit TiledStorage(const Img_t &mask) : data{} {
+        for (uint y = 0; y < H; ++y)
+            for (uint x = 0; x < W; ++x)
+                set(x, y, mask[y][x]);
+    }
+
+    /// Get the value of the given pixel.
+    constexpr uint8_t get(uint x, uint y) const { return data[index(x, y)]; }
+    /// Set the value of the given pixel.
+    void set(uint x, uint y, uint8_t value) { data[index(x, y)] = value; }
+    /// Get the address of the given pixel (for prefetching).
+    const uint8_t *address(uint x, uint y) const { return &data[index(x, y)]; }
+    /// Get the pixel of the input mask that's stored at the given pixel.
+    constexpr static Pixel source(uint x, uint y) { return {x, y}; }
+
+    /// The coordinates are those of the input mask.
+    constexpr static bool REMAPS = false;
+
+  private:
+    constexpr static size_t index(uint x, uint y) {
+        size_t tile = (y / Tile) * TILES_X + x / Tile;
+        return tile * Tile * Tile + (y % Tile) * Tile + x % Tile;
+    }
+
+    alignas(64) std::array<uint8_t, TILES_X * TILES_Y * Tile * Tile> data;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Matrix.hpp>
+#include <Pixel.hpp>
+#include <algorithm>  // min, max
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>  // memcpy
+#include <uint.hpp>
+
+/**
+ * @file
+ *
+ * A coarse summary of where the white pixels of a mask are.
+ *
+ * GridFinder builds an #OccupancyMap when the mask is loaded, so it can reject
+ * frames that can't contain a grid (too dark, overexposed, or a single blob)
+ * by looking at a few hundred counters, before starting the actual search.
+ */
+
+/// The white pixels in (the cells that overlap) a region of the mask.
+/// @see    OccupancyMap::summarize
+struct OccupancySummary {
+    uint white;  ///< The number of white pixels.
+    uint area;   ///< The total number of pixels in the cells.
+    /// The size of the bounding box of all cells that contain white pixels,
+    /// in pixels, or zero if there are no white pixels.
+    uint extentX, extentY;
+};
+
+/**
+ * @brief   The number of white pixels in each cell of Cell×Cell pixels of a
+ *          mask.
+ *
+ * @tparam  W
+ *          The width of the image in pixels.
+ * @tparam  H
+ *          The height of the image in pixels.
+ * @tparam  Cell
+ *          The side of a cell in pixels. The cells at the right and bottom
+ *          edges may be smaller.
+ */
+template <size_t W, size_t H, uint Cell = 16>
+class OccupancyMap {
+    static_assert(Cell > 0 && Cell * Cell <= UINT16_MAX,
+                  "The count of a cell must fit in 16 bits");
+
+  public:
+    /// The type of the image mask.
+    using Img_t = TMatrix<uint8_t, H, W>;
+
+    /// The number of cells in a row.
+    constexpr static size_t CELLS_X = (W + Cell - 1) / Cell;
+    /// The number of rows of cells.
+    constexpr static size_t CELLS_Y = (H + Cell - 1) / Cell;
+
+    /// The map of a mask of all zeros.
+    OccupancyMap() : counts{} {}
+    /// Count the white pixels of the given mask. One pass over the mask.
+    explicit OccupancyMap(const Img_t &mask) : counts{} {
+        for (uint y = 0; y < H; ++y) {
+            const uint8_t *px = &mask[y][0];
+            uint16_t *row     = &counts[(y / Cell) * CELLS_X];
+            for (uint cx = 0; cx < W / Cell; ++cx, px += Cell)
+                row[cx] += countNonZero(px);
+            for (uint x = W / Cell * Cell; x < W; ++x)
+                row[W / Cell] += *px++ != 0;
+        }
+    }
+
+    /// Update the map when a pixel changes from @p before to @p after.
+    void update(uint x, uint y, uint8_t before, uint8_t after) {
+        uint16_t &count = counts[(y / Cell) * CELLS_X + x / Cell];
+        count += (after != 0) - (before != 0);
+    }
+
+    /// Get the number of white pixels in the cell that contains the given
+    /// pixel.
+    uint getCount(uint x, uint y) const {
+        return counts[(y / Cell) * CELLS_X + x / Cell];
+    }
+
+    /**
+     * @brief   Summarize all cells that overlap the given region. Cells on the
+     *          edge of the region are counted entirely, so the result is exact
+     *          only if the region is aligned to the cells.
+     */
+    OccupancySummary summarize(Rect region) const {
+        OccupancySummary result = {0, 0, 0, 0};
+        if (region.width == 0 || region.height == 0)
+            return result;
+        const uint cx0 = region.x / Cell;
+        const uint cy0 = region.y / Cell;
+        const uint cx1 = (region.x + region.width - 1) / Cell;
+        const uint cy1 = (region.y + region.height - 1) / Cell;
+        uint minX = CELLS_X, maxX = 0, minY = CELLS_Y, maxY = 0;
+        for (uint cy = cy0; cy <= cy1; ++cy) {
+            for (uint cx = cx0; cx <= cx1; ++cx) {
+                const uint count = counts[cy * CELLS_X + cx];
+                if (count == 0)
+                    continue;
+                result.white += count;
+                minX = std::min(minX, cx), maxX = std::max(maxX, cx);
+                minY = std::min(minY, cy), maxY = std::max(maxY, cy);
+            }
+        }
+        const uint x1  = std::min<uint>((cx1 + 1) * Cell, W);
+        const uint y1  = std::min<uint>((cy1 + 1) * Cell, H);
+        result.area    = (x1 - cx0 * Cell) * (y1 - cy0 * Cell);
+        if (result.white > 0) {
+            result.extentX = (maxX - minX + 1) * Cell;
+            result.extentY = (maxY - minY + 1) * Cell;
+        }
+        return result;
+    }
+
+  private:
+    /// Count the non-zero bytes of a complete row of a cell, eight bytes at a
+    /// time (SWAR): every byte is folded into its lowest bit, and the bits
+    /// are added up by a multiplication.
+    static uint countNonZero(const uint8_t *px) {
+        uint count = 0;
+        for (uint i = 0; i < Cell; i += sizeof(uint64_t)) {
+            if (Cell - i < sizeof(uint64_t)) {
+                for (uint j = i; j < Cell; ++j)
+                    count += px[j] != 0;
+                break;
+            }
+            uint64_t v;
+            std::memcpy(&v, px + i, sizeof(v));
+            v |= v >> 4;
+            v |= v >> 2;
+            v |= v >> 1;
+            v &= 0x0101010101010101;
+            count += (v * 0x0101010101010101) >> 56;
+        }
+        return count;
+    }
+
+    std::array<uint16_t, CELLS_X * CELLS_Y> counts;
+};
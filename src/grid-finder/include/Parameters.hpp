@@ -0,0 +1,234 @@
+#pragma once
+
+#include <Angle.hpp>
+#include <Config.hpp>
+#include <cstddef>
+#include <uint.hpp>
+#if GRID_FINDER_IOSTREAM
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#endif
+
+/**
+ * @file
+ *
+ * The detection thresholds of GridFinder.
+ *
+ * GridFinder accesses all thresholds through an object of its `Parameters`
+ * type, e.g. `params.MAX_LINE_WIDTH`. This can either be #DefaultParameters,
+ * where all thresholds are compile-time constants (this is the fast path, the
+ * compiler can fold them into the code), or #RuntimeParameters, where all
+ * thresholds are ordinary data members that can be changed without
+ * recompiling, e.g. from Python or during a parameter sweep.
+ * The members have the same names in both, so the same code works for both.
+ *
+ * #RuntimeParameters can be saved to and loaded from a profile file, with one
+ * `NAME = value` pair per line (see `applications/autotune`).
+ */
+
+/**
+ * @brief   The default thresholds, as compile-time constants.
+ *
+ * @tparam  W
+ *          The width of the image in pixels.
+ * @tparam  H
+ *          The height of the image in pixels.
+ * @tparam  Downscale
+ *          The factor by which the image was downsampled, compared to the
+ *          resolution the thresholds were tuned for. All thresholds that are
+ *          expressed in pixels (line widths, gaps, jumps) are divided by this
+ *          factor. See PyramidGridFinder.
+ */
+template <size_t W, size_t H, uint Downscale = 1>
+struct DefaultParameters {
+    static_assert(Downscale >= 1 && Downscale <= 10,
+                  "Thresholds cannot be scaled down this far");
+
+    /// When this many consecutive black pixels are encountered, stop following
+    /// the line.
+    constexpr static uint HOUGH_MAX_GAP = 16 / Downscale;
+
+    /**
+     * @brief   The maximum number of pixels that can be black within a line,
+     *          while still being detected correctly.
+     */
+    constexpr static uint MAX_GAP = 10 / Downscale;
+
+    /**
+     * @brief   "Lines" that are wider than this value are ignored, to prevent
+     *          white blobs (of sunlight, for example) from being detected as
+     *          random lines.
+     */
+    constexpr static uint MAX_LINE_WIDTH = 32 / Downscale;
+
+    /// When we're at an intersection and no width can be determined, how
+    /// far should we jump along the line before trying again.
+    constexpr static uint RETRY_JUMP_DISTANCE = MAX_LINE_WIDTH;  // TODO
+
+    /// The minimum width the first line must have.
+    constexpr static uint MINIMUM_START_LINE_WIDTH = 10 / Downscale;
+    /// The minimum number of Hough votes the first line must have.
+    /// @see    HoughResult::count
+    constexpr static uint MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT = (W + H) / 10;
+
+    /// Don't use vertical lines as the first line, as this can result in
+    /// finding a first square that's not in the center of the frame.
+    constexpr static uint MAXIMUM_VERTICAL_START_LINE_WIDTH = 32 / Downscale;
+
+    /// If no valid first line is found in a column, don't try the column right
+    /// next to it, but go a little farther.
+    constexpr static uint FIRST_LINE_INVALID_HORIZONTAL_JUMP = 10 / Downscale;
+
+    /// Perpendicular lines have to be long enough to be counted as a real line.
+    constexpr static uint MINIMIM_LINE_WEIGHTED_VOTE_COUNT = (W + H) / 10;
+
+    /// Only scan every n-th angle when looking for the first angle estimate
+    /// (GridFinder::findLineAngle).
+    constexpr static uint HOUGH_ANGLE_STEP = 1;
+
+    /// The number of angle steps on either side of the estimate that are
+    /// scanned by GridFinder::findLineAngleAccurateRange.
+    constexpr static uint ACCURATE_ANGLE_RANGE =
+        angle_t::resolution() / 40;  // 2 * 9°
+
+    /// Frames with fewer white pixels than this are rejected without
+    /// searching (e.g. frames that are too dark). A single line that's long
+    /// enough to get #MINIMIM_LINE_WEIGHTED_VOTE_COUNT votes already has
+    /// about this many pixels. Zero disables the check.
+    /// @see    GridFinder::checkFrame
+    constexpr static uint MINIMUM_WHITE_PIXELS = (W + H) / 10;
+
+    /// Frames where more than this percentage of the pixels is white are
+    /// rejected without searching (e.g. overexposed frames). Grid lines are
+    /// at most #MAX_LINE_WIDTH wide, so they only cover a fraction of the
+    /// frame. 100 disables the check.
+    /// @see    GridFinder::checkFrame
+    constexpr static uint MAXIMUM_WHITE_PERCENTAGE = 60;
+};
+
+/**
+ * @brief   Thresholds that can be changed at runtime. They are initialized to
+ *          the same values as #DefaultParameters.
+ *
+ * @note    The names are in upper case, like the constants in
+ *          #DefaultParameters, so GridFinder can use either one.
+ */
+template <size_t W, size_t H>
+struct RuntimeParameters {
+    using Default_t = DefaultParameters<W, H>;
+
+    /// @copydoc DefaultParameters::HOUGH_MAX_GAP
+    uint HOUGH_MAX_GAP = Default_t::HOUGH_MAX_GAP;
+    /// @copydoc DefaultParameters::MAX_GAP
+    uint MAX_GAP = Default_t::MAX_GAP;
+    /// @copydoc DefaultParameters::MAX_LINE_WIDTH
+    uint MAX_LINE_WIDTH = Default_t::MAX_LINE_WIDTH;
+    /// @copydoc DefaultParameters::RETRY_JUMP_DISTANCE
+    uint RETRY_JUMP_DISTANCE = Default_t::RETRY_JUMP_DISTANCE;
+    /// @copydoc DefaultParameters::MINIMUM_START_LINE_WIDTH
+    uint MINIMUM_START_LINE_WIDTH = Default_t::MINIMUM_START_LINE_WIDTH;
+    /// @copydoc DefaultParameters::MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT
+    uint MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT =
+        Default_t::MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT;
+    /// @copydoc DefaultParameters::MAXIMUM_VERTICAL_START_LINE_WIDTH
+    uint MAXIMUM_VERTICAL_START_LINE_WIDTH =
+        Default_t::MAXIMUM_VERTICAL_START_LINE_WIDTH;
+    /// @copydoc DefaultParameters::FIRST_LINE_INVALID_HORIZONTAL_JUMP
+    uint FIRST_LINE_INVALID_HORIZONTAL_JUMP =
+        Default_t::FIRST_LINE_INVALID_HORIZONTAL_JUMP;
+    /// @copydoc DefaultParameters::MINIMIM_LINE_WEIGHTED_VOTE_COUNT
+    uint MINIMIM_LINE_WEIGHTED_VOTE_COUNT =
+        Default_t::MINIMIM_LINE_WEIGHTED_VOTE_COUNT;
+    /// @copydoc DefaultParameters::HOUGH_ANGLE_STEP
+    uint HOUGH_ANGLE_STEP = Default_t::HOUGH_ANGLE_STEP;
+    /// @copydoc DefaultParameters::ACCURATE_ANGLE_RANGE
+    uint ACCURATE_ANGLE_RANGE = Default_t::ACCURATE_ANGLE_RANGE;
+    /// @copydoc DefaultParameters::MINIMUM_WHITE_PIXELS
+    uint MINIMUM_WHITE_PIXELS = Default_t::MINIMUM_WHITE_PIXELS;
+    /// @copydoc DefaultParameters::MAXIMUM_WHITE_PERCENTAGE
+    uint MAXIMUM_WHITE_PERCENTAGE = Default_t::MAXIMUM_WHITE_PERCENTAGE;
+
+    /// Call `f(name, value)` for every parameter.
+    template <class F>
+    void forEach(F &&f) {
+        visit(*this, f);
+    }
+    /// @copydoc forEach
+    template <class F>
+    void forEach(F &&f) const {
+        visit(*this, f);
+    }
+
+  private:
+    template <class Self, class F>
+    static void visit(Self &self, F &f) {
+        f("HOUGH_MAX_GAP", self.HOUGH_MAX_GAP);
+        f("MAX_GAP", self.MAX_GAP);
+        f("MAX_LINE_WIDTH", self.MAX_LINE_WIDTH);
+        f("RETRY_JUMP_DISTANCE", self.RETRY_JUMP_DISTANCE);
+        f("MINIMUM_START_LINE_WIDTH", self.MINIMUM_START_LINE_WIDTH);
+        f("MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT",
+          self.MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT);
+        f("MAXIMUM_VERTICAL_START_LINE_WIDTH",
+          self.MAXIMUM_VERTICAL_START_LINE_WIDTH);
+        f("FIRST_LINE_INVALID_HORIZONTAL_JUMP",
+          self.FIRST_LINE_INVALID_HORIZONTAL_JUMP);
+        f("MINIMIM_LINE_WEIGHTED_VOTE_COUNT",
+          self.MINIMIM_LINE_WEIGHTED_VOTE_COUNT);
+        f("HOUGH_ANGLE_STEP", self.HOUGH_ANGLE_STEP);
+        f("ACCURATE_ANGLE_RANGE", self.ACCURATE_ANGLE_RANGE);
+        f("MINIMUM_WHITE_PIXELS", self.MINIMUM_WHITE_PIXELS);
+        f("MAXIMUM_WHITE_PERCENTAGE", self.MAXIMUM_WHITE_PERCENTAGE);
+    }
+};
+
+#if GRID_FINDER_IOSTREAM
+
+/// Write the parameters as a profile, one `NAME = value` pair per line.
+template <size_t W, size_t H>
+std::ostream &operator<<(std::ostream &os, const RuntimeParameters<W, H> &p) {
+    p.forEach([&os](const char *name, uint value) {
+        os << name << " = " << value << "\n";
+    });
+    return os;
+}
+
+#if GRID_FINDER_EXCEPTIONS
+
+/**
+ * @brief   Read a profile that was written using 
+ *          operator<<(std::ostream &, const RuntimeParameters<W, H> &).
+ *          Parameters that are not in the profile keep their default value.
+ *
+ * @throws  std::runtime_error
+ *          If the profile contains an unknown parameter, an invalid line, or
+ *          a value that's negative or too large.
+ */
+template <size_t W, size_t H>
+RuntimeParameters<W, H> readParameters(std::istream &is) {
+    RuntimeParameters<W, H> params;
+    std::string key, equals;
+    while (is >> key) {
+        long long value;
+        if (!(is >> equals >> value) || equals != "=" || value < 0 ||
+            value > std::numeric_limits<uint>::max())
+            throw std::runtime_error("Error: invalid profile line for " + key);
+        bool found = false;
+        params.forEach([&](const char *name, uint &member) {
+            if (key == name) {
+                member = value;
+                found  = true;
+            }
+        });
+        if (!found)
+            throw std::runtime_error("Error: unknown parameter " + key);
+    }
+    return params;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <uint.hpp>
+
+/// The position of a pixel relative to the start of a stencil.
+struct StencilOffset {
+    int8_t x, y;
+};
+
+/**
+ * @brief   Lookup tables with the pixels of the perpendicular width probes of
+ *          GridFinder, for every angle.
+ *
+ * A Bresenham line only depends on its direction, not on its starting point,
+ * so the first @p Length pixels of the line in the direction perpendicular to
+ * each angle can be computed at compile time. Following the stencil gives
+ * exactly the same pixels as `BresenhamLine(start, angle.perpendicular(true))`.
+ * Negating all offsets gives the pixels of
+ * `BresenhamLine(start, angle.perpendicular(false))`.
+ *
+ * @tparam  Angle
+ *          The angle type, e.g. #angle_t.
+ * @tparam  Length
+ *          The number of pixels of each stencil, at most 128.
+ */
+template <class Angle, uint Length>
+class PerpendicularStencils {
+    static_assert(Length > 0 && Length <= 128,
+                  "Offsets must fit in a signed byte");
+
+  public:
+    /// The pixels of the probe in one direction, starting with {0, 0}.
+    using Stencil = std::array<StencilOffset, Length>;
+
+    /// Get the stencil perpendicular to the given angle (+90°).
+    static const Stencil &get(Angle angle) { return table[angle.getIndex()]; }
+
+  private:
+    using Table = std::array<Stencil, Angle::resolution()>;
+
+    /// Same algorithm as BresenhamLine::next.
+    static constexpr Stencil calculate(int dx, int dy) {
+        const int adx  = dx < 0 ? -dx : dx;
+        const int ady  = dy < 0 ? -dy : dy;
+        const int xinc = (0 < dx) - (dx < 0);
+        const int yinc = (0 < dy) - (dy < 0);
+        const bool steep = ady > adx;
+        int error        = steep ? (adx - ady) / 2 : (ady - adx) / 2;
+        int x = 0, y = 0;
+        Stencil stencil = {};
+        for (uint i = 0; i < Length; ++i) {
+            stencil[i] = {int8_t(x), int8_t(y)};
+            if (steep) {
+                if (error >= 0) {
+                    x += xinc;
+                    error -= 2 * ady;
+                }
+                y += yinc;
+                error += 2 * adx;
+            } else {
+                if (error >= 0) {
+                    y += yinc;
+                    error -= 2 * adx;
+                }
+                x += xinc;
+                error += 2 * ady;
+            }
+        }
+        return stencil;
+    }
+
+    static constexpr Table calculateTable() {
+        Table table = {};
+        for (uint i = 0; i < Angle::resolution(); ++i) {
+            Angle angle = Angle(i);
+            table[i]    = calculate(-angle.sin(), angle.cos());
+        }
+        return table;
+    }
+
+    static constexpr Table table = calculateTable();
+};
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <Config.hpp>
 #include <uint.hpp>
+#if GRID_FINDER_IOSTREAM
 #include <ostream>
+#endif
 
 struct Pixel {
     constexpr Pixel(uint x, uint y) : x(x), y(y) {}
@@ -23,6 +26,30 @@ struct Pixel {
     }
 };
 
+#if GRID_FINDER_IOSTREAM
 inline std::ostream &operator<<(std::ostream &os, Pixel p) {
     return os << '(' << p.x << ", " << p.y << ')';
-}
\ No newline at end of file
+}
+#endif
+
+/// A rectangular region of an image.
+struct Rect {
+    uint x, y;           ///< The top left corner.
+    uint width, height;  ///< The size of the region in pixels.
+    bool contains(Pixel px) const {
+        // Unsigned comparison also checks for >= x and >= y
+        return px.x - x < width && px.y - y < height;
+    }
+    Pixel center() const { return {x + (width - 1) / 2, y + (height - 1) / 2}; }
+    bool operator==(Rect other) const {
+        return x == other.x && y == other.y && width == other.width &&
+               height == other.height;
+    }
+};
+
+#if GRID_FINDER_IOSTREAM
+inline std::ostream &operator<<(std::ostream &os, Rect r) {
+    return os << "Rect(" << Pixel(r.x, r.y) << ", " << r.width << "×"
+              << r.height << ')';
+}
+#endif
\ No newline at end of file
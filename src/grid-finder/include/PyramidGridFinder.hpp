@@ -0,0 +1,177 @@
+#pragma once
+
+#include <GridFinder.hpp>
+#include <algorithm>  // min
+#include <memory>
+
+/**
+ * @brief   Finds the square on a downsampled copy of the mask, and then refines
+ *          the lines that were found at full resolution.
+ *
+ * Most of the work (the 360° scans of the first line and the searches for the
+ * perpendicular lines) is done on the coarse mask, which has only
+ * 1/@p Factor² of the pixels. The coarse mask is created using OR-pooling, so
+ * thin lines survive the downsampling.
+ * Afterwards, the middle, width and angle of each line are determined again on
+ * the full resolution mask, using only a narrow angle range around the coarse
+ * estimate.
+ *
+ * @tparam  W
+ *          The width of the full resolution image in pixels.
+ * @tparam  H
+ *          The height of the full resolution image in pixels.
+ * @tparam  Factor
+ *          The downsampling factor (e.g. 2 or 4).
+ */
+template <size_t W, size_t H, uint Factor = 2>
+class PyramidGridFinder {
+  public:
+    /// The type of the full resolution image mask.
+    using Img_t = TMatrix<uint8_t, H, W>;
+    /// The finder used on the full resolution mask.
+    using Fine_t = GridFinder<W, H>;
+    /// The thresholds for the downsampled mask.
+    using CoarseParameters_t =
+        DefaultParameters<W / Factor, H / Factor, Factor>;
+    /// The finder used on the downsampled mask.
+    using Coarse_t = GridFinder<W / Factor, H / Factor, CoarseParameters_t>;
+
+    /// The type of the downsampled image mask.
+    using CoarseImg_t = typename Coarse_t::Img_t;
+
+    /// Constructor from a given full resolution mask.
+    PyramidGridFinder(const Img_t &mask)
+        : fine(std::make_unique<Fine_t>(mask)),
+          coarseMask(std::make_unique<CoarseImg_t>()) {
+        downsample(mask, *coarseMask);
+        coarse = std::make_unique<Coarse_t>(*coarseMask);
+    }
+
+    /**
+     * @brief   Replace the mask, e.g. by the next frame of a stream. The
+     *          downsampled mask is reused, so nothing is allocated.
+     */
+    void setMask(const Img_t &mask) {
+        fine->setMask(mask);
+        downsample(mask, *coarseMask);
+        coarse->setMask(*coarseMask);
+    }
+
+    /**
+     * @brief   Downsample the given mask by @p Factor, using OR-pooling: a pixel
+     *          of the coarse mask is white if any of the pixels in the
+     *          corresponding block of the fine mask is white.
+     *          Pixels in the last incomplete block of each row or column are
+     *          added to the last complete block.
+     */
+    static void downsample(const Img_t &mask, CoarseImg_t &result) {
+        constexpr uint w = W / Factor;
+        constexpr uint h = H / Factor;
+        for (auto &row : result)
+            row.fill(0x00);
+        for (uint y = 0; y < H; ++y) {
+            auto &row = result[std::min(y / Factor, h - 1)];
+            for (uint x = 0; x < W; ++x)
+                if (mask[y][x])
+                    row[std::min(x / Factor, w - 1)] = 0xFF;
+        }
+    }
+
+    /// The number of angle steps around the coarse estimate that are searched
+    /// when refining a line at full resolution.
+    constexpr static uint REFINE_ANGLE_RANGE = angle_t::resolution() / 120;
+
+    /**
+     * @brief   Convert a line found on the coarse mask to full resolution
+     *          coordinates, and determine its middle, width and angle on the
+     *          full resolution mask.
+     *
+     * @return  The refined line, or the scaled coarse line if the middle of the
+     *          line cannot be found at full resolution, or if the budget of
+     *          the full resolution finder is used up (in which case the angle
+     *          histogram would be incomplete).
+     */
+    LineResult refine(LineResult coarseLine) const {
+        const Pixel c = coarseLine.lineCenter;
+        Pixel center  = {
+            std::min<uint>(c.x * Factor + Factor / 2, W - 1),
+            std::min<uint>(c.y * Factor + Factor / 2, H - 1),
+        };
+        LineResult scaled = {center, coarseLine.width * Factor,
+                             coarseLine.angle, coarseLine.votes,
+                             coarseLine.confidence};
+        if (fine->getBudget().exhausted())
+            return scaled;
+        optional<GetMiddleResult> middle =
+            fine->getMiddleWithRetries(center, coarseLine.angle);
+        if (!middle.has_value())
+            return scaled;
+        optional<HoughPeak> result =
+            fine->template findLineAngleAccurateRange<REFINE_ANGLE_RANGE>(
+                middle->pixel, coarseLine.angle);
+        if (!result.has_value())
+            return scaled;
+        return fine->makeLine(middle->pixel, middle->width,
+                              middle->widthSpread, *result,
+                              REFINE_ANGLE_RANGE);
+    }
+
+    /**
+     * @brief   Find the square on the downsampled mask, and refine it at full
+     *          resolution.
+     *
+     * @param   limit
+     *          The budget for the entire search: the search on the coarse
+     *          mask, and whatever is left of it for the refinement.
+     * @return  The square in full resolution coordinates.
+     */
+    Square findSquare(SearchBudget limit = SearchBudget()) {
+        Square coarseSq = coarse->findSquare(limit);
+        Square sq;
+        sq.status = coarseSq.status;
+        // The refinement gets what's left of the budget
+        limit.charge(coarse->getStepCount());
+        fine->setBudget(limit);
+        for (size_t i = 0; i < sq.lines.size(); ++i)
+            if (coarseSq.lines[i].has_value())
+                sq.lines[i] = refine(*coarseSq.lines[i]);
+        const SearchBudget &used = fine->getBudget();
+        sq.truncated  = coarseSq.truncated ||
+                       (sq.status == SearchStatus::Ok && used.wasExhausted());
+        lastStepCount = used.getStepCount();
+        // Don't limit any functions that are called outside of findSquare
+        fine->setBudget(SearchBudget());
+        // Same intersections as GridFinder::findSquare
+        auto intersect = [&sq](size_t corner, size_t a, size_t b) {
+            if (!sq.lines[a].has_value() || !sq.lines[b].has_value())
+                return;
+            sq.points[corner] = Fine_t::intersect(*sq.lines[a], *sq.lines[b]);
+            sq.pointConfidence[corner] =
+                Fine_t::cornerConfidence(*sq.lines[a], *sq.lines[b]);
+        };
+        intersect(0, 0, 2);
+        intersect(1, 1, 3);
+        intersect(2, 2, 4);
+        intersect(3, 3, 4);
+        sq.homography = Fine_t::squareHomography(sq);
+        return sq;
+    }
+
+    /// Get the number of Bresenham steps used by the last #findSquare call,
+    /// on both the coarse and the full resolution mask.
+    size_t getStepCount() const { return lastStepCount; }
+
+    /// Get the finder that works on the full resolution mask.
+    const Fine_t &getFine() const { return *fine; }
+    /// Get the finder that works on the downsampled mask.
+    const Coarse_t &getCoarse() const { return *coarse; }
+
+  private:
+    /// The masks are too large to put on the stack, so they're allocated once,
+    /// when the finder is created.
+    std::unique_ptr<Fine_t> fine;
+    std::unique_ptr<CoarseImg_t> coarseMask;
+    std::unique_ptr<Coarse_t> coarse;
+    /// The number of steps used by the last call to #findSquare.
+    size_t lastStepCount = 0;
+};
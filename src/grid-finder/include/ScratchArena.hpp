@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Config.hpp>
+#include <Span.hpp>
+#include <algorithm>  // max
+#include <cstddef>
+#include <cstdlib>  // abort
+#include <new>  // bad_alloc, placement new
+#include <type_traits>
+
+/**
+ * @brief   A fixed-size bump allocator for temporary data that only lives
+ *          for the duration of a single frame (vote histograms, candidate
+ *          lines, intersection lists ...).
+ *
+ * Allocating is just incrementing an offset, and all memory is released at
+ * once by calling #reset, so no heap allocations are needed on the hot path.
+ * Nested temporaries can release their memory early by using a #Scope.
+ *
+ * @tparam  Capacity
+ *          The size of the arena in bytes.
+ */
+template <size_t Capacity>
+class ScratchArena {
+  public:
+    /**
+     * @brief   Allocate and default-construct an array of @p count elements.
+     *
+     * @throws  std::bad_alloc
+     *          If the arena doesn't have enough space left. Without exceptions,
+     *          the program is aborted instead, so users have to make sure
+     *          at compile time that the capacity is sufficient.
+     */
+    template <class T>
+    Span<T> allocate(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "Destructors of objects in the arena are never called");
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+        size_t start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+        size_t end   = start + count * sizeof(T);
+        if (end > Capacity) {
+#if GRID_FINDER_EXCEPTIONS
+            throw std::bad_alloc();
+#else
+            std::abort();
+#endif
+        }
+        used          = end;
+        highWaterMark = std::max(highWaterMark, used);
+        ++allocationCount;
+        T *data = reinterpret_cast<T *>(buffer + start);
+        for (size_t i = 0; i < count; ++i)
+            new (data + i) T;
+        return {data, count};
+    }
+
+    /// Release all memory in the arena. This is O(1).
+    void reset() { used = 0; }
+
+    /**
+     * @brief   Releases all memory that was allocated during its lifetime when
+     *          it goes out of scope.
+     */
+    class Scope {
+      public:
+        Scope(ScratchArena &arena) : arena(arena), mark(arena.used) {}
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope() { arena.used = mark; }
+
+      private:
+        ScratchArena &arena;
+        const size_t mark;
+    };
+
+    /// Get the number of bytes that are currently in use.
+    size_t getUsed() const { return used; }
+    /// Get the maximum number of bytes that were ever in use at once.
+    size_t getHighWaterMark() const { return highWaterMark; }
+    /// Get the total number of allocations from this arena.
+    size_t getAllocationCount() const { return allocationCount; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+  private:
+    alignas(std::max_align_t) std::byte buffer[Capacity];
+    size_t used            = 0;
+    size_t highWaterMark   = 0;
+    size_t allocationCount = 0;
+};
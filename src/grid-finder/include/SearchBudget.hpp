@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+/**
+ * @brief   A limit on the amount of work (number of Bresenham steps) and/or
+ *          time a search is allowed to take.
+ *
+ * The ray-walking primitives #charge the budget for every pixel they visit,
+ * and the search loops check whether the budget is #exhausted before
+ * starting a new iteration. The clock is only read once every
+ * #CLOCK_CHECK_INTERVAL steps, because reading it is much more expensive than
+ * a single step. A search can also be cancelled from another thread, through
+ * a flag that is passed to #cancelWhen.
+ */
+class SearchBudget {
+  public:
+    /// The clock used for deadlines. Bare-metal targets without a system clock
+    /// can define `GRID_FINDER_CLOCK` as their own type that meets the
+    /// requirements of a C++ clock, e.g. one that reads a cycle counter.
+#ifdef GRID_FINDER_CLOCK
+    using Clock = GRID_FINDER_CLOCK;
+#else
+    using Clock = std::chrono::steady_clock;
+#endif
+
+    /// Only read the clock after this many steps.
+    constexpr static size_t CLOCK_CHECK_INTERVAL = 1024;
+
+    /// Create an unlimited budget.
+    SearchBudget() = default;
+
+    /// Create a budget that allows at most the given number of steps.
+    static SearchBudget steps(size_t maxSteps) {
+        SearchBudget b;
+        b.maxSteps = maxSteps;
+        return b;
+    }
+
+    /// Create a budget that expires at the given point in time.
+    static SearchBudget until(Clock::time_point deadline) {
+        SearchBudget b;
+        b.deadline    = deadline;
+        b.hasDeadline = true;
+        return b;
+    }
+
+    /// Create a budget that expires after the given duration from now.
+    static SearchBudget within(Clock::duration duration) {
+        return until(Clock::now() + duration);
+    }
+
+    /// Limit the number of steps of a budget that already has a deadline.
+    SearchBudget &limitSteps(size_t maxSteps) {
+        this->maxSteps = maxSteps;
+        return *this;
+    }
+
+    /**
+     * @brief   Also stop when the given flag is set, e.g. by another thread
+     *          because a newer frame arrived. The flag must outlive the
+     *          search.
+     */
+    SearchBudget &cancelWhen(const std::atomic<bool> &flag) {
+        cancelFlag = &flag;
+        return *this;
+    }
+
+    /// Use up the given number of steps.
+    void charge(size_t steps) { used += steps; }
+
+    /// Exhaust the budget, so the search stops as soon as possible, e.g.
+    /// because of an error.
+    void cancel() { isExhausted = true; }
+
+    /**
+     * @brief   Check whether the budget is used up. Once it is, it stays
+     *          exhausted.
+     */
+    bool exhausted() {
+        if (isExhausted)
+            return true;
+        if (cancelFlag && cancelFlag->load(std::memory_order_relaxed))
+            return isCancelled = isExhausted = true;
+        if (used > maxSteps)
+            return isExhausted = true;
+        if (hasDeadline && used >= nextClockCheck) {
+            nextClockCheck = used + CLOCK_CHECK_INTERVAL;
+            if (Clock::now() >= deadline)
+                return isExhausted = true;
+        }
+        return false;
+    }
+
+    /// Check whether the budget ran out during the search, without checking
+    /// the clock.
+    bool wasExhausted() const { return isExhausted; }
+
+    /// Check whether the search was stopped by the flag of #cancelWhen.
+    bool wasCancelled() const { return isCancelled; }
+
+    /// Get the number of steps used so far.
+    size_t getStepCount() const { return used; }
+
+  private:
+    size_t maxSteps = std::numeric_limits<size_t>::max();
+    size_t used     = 0;
+    Clock::time_point deadline;
+    size_t nextClockCheck               = 0;
+    const std::atomic<bool> *cancelFlag = nullptr;
+    bool hasDeadline                    = false;
+    bool isExhausted                    = false;
+    bool isCancelled                    = false;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>  // reverse_iterator
+
+/**
+ * @brief   A non-owning view of a contiguous range of elements.
+ *          (A minimal stand-in for C++20's `std::span`.)
+ */
+template <class T>
+class Span {
+  public:
+    using value_type = T;
+    using iterator   = T *;
+    using reverse_iterator = std::reverse_iterator<T *>;
+
+    constexpr Span() = default;
+    constexpr Span(T *data, size_t size) : first(data), count(size) {}
+    template <size_t N>
+    constexpr Span(std::array<std::remove_const_t<T>, N> &array)
+        : first(array.data()), count(N) {}
+    template <size_t N>
+    constexpr Span(const std::array<std::remove_const_t<T>, N> &array)
+        : first(array.data()), count(N) {}
+
+    /// Implicit conversion to a span of constant elements.
+    constexpr operator Span<const T>() const { return {first, count}; }
+
+    constexpr T *data() const { return first; }
+    constexpr size_t size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+
+    constexpr T &operator[](size_t index) const { return first[index]; }
+
+    constexpr T *begin() const { return first; }
+    constexpr T *end() const { return first + count; }
+    reverse_iterator rbegin() const { return reverse_iterator(end()); }
+    reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+  private:
+    T *first     = nullptr;
+    size_t count = 0;
+};
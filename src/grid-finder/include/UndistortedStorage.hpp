@@ -0,0 +1,155 @@
+#pragma once
+
+#include <Line.hpp>
+#include <MaskStorage.hpp>
+#include <Matrix.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <uint.hpp>
+
+/**
+ * @brief   Presents a mask that was captured through a wide-angle lens in
+ *          undistorted coordinates, so the grid lines are straight again.
+ *
+ * The mask itself is stored as is (in an object of the `Inner` storage type),
+ * it's not remapped as a whole. Instead, every pixel that GridFinder reads is
+ * looked up in a per-pixel remap table first: pixel (x, y) of the undistorted
+ * image is pixel `table[y][x]` of the mask. The rays only touch a small part
+ * of the frame, so this is much cheaper than undistorting the entire mask for
+ * every frame. The table only depends on the lens, so it's computed once, and
+ * shared by all GridFinders with the same lens.
+ *
+ * All coordinates that GridFinder returns (lines, points, the region of
+ * interest) are undistorted coordinates. Use #distort to convert them back to
+ * the coordinates of the camera image.
+ *
+ * The lens is described by the radial (Brown–Conrady) model: an undistorted
+ * point at a distance @f$ r @f$ from the center (in units of the focal length)
+ * is imaged at a distance @f$ r (1 + k_1 r^2 + k_2 r^4) @f$. Pixels that fall
+ * outside of the camera image are black.
+ *
+ * @tparam  W
+ *          The width of the image in pixels.
+ * @tparam  H
+ *          The height of the image in pixels.
+ * @tparam  Lens
+ *          The calibration of the camera, a type with the compile-time
+ *          constants `K1`, `K2` (the radial distortion coefficients),
+ *          `CENTER_X`, `CENTER_Y` (the principal point in pixels) and
+ *          `FOCAL_LENGTH` (in pixels), all of type `float`.
+ * @tparam  Inner
+ *          The memory layout of the distorted mask, see MaskStorage.hpp.
+ */
+template <size_t W, size_t H, class Lens, class Inner = RowMajorStorage<W, H>>
+class UndistortedStorage {
+    static_assert(W < 0xFFFF && H < 0xFFFF,
+                  "The remap table stores coordinates as 16-bit integers");
+
+  public:
+    /// The type of the image mask.
+    using Img_t = TMatrix<uint8_t, H, W>;
+
+    /// Create a mask of all zeros.
+    UndistortedStorage() : raw{}, remap(table().entries.data()) {}
+    /// Copy the given (distorted) mask.
+    explicit UndistortedStorage(const Img_t &mask)
+        : raw(mask), remap(table().entries.data()) {}
+
+    /// Get the value of the given pixel of the undistorted image.
+    uint8_t get(uint x, uint y) const {
+        Entry e = remap[y * W + x];
+        return e.x == OUTSIDE ? 0 : raw.get(e.x, e.y);
+    }
+    /// Set the pixel of the mask that's imaged at the given pixel of the
+    /// undistorted image.
+    void set(uint x, uint y, uint8_t value) {
+        Entry e = remap[y * W + x];
+        if (e.x != OUTSIDE)
+            raw.set(e.x, e.y, value);
+    }
+    /// Get the address of the given pixel (for prefetching).
+    const uint8_t *address(uint x, uint y) const {
+        Entry e = remap[y * W + x];
+        return e.x == OUTSIDE ? raw.address(0, 0) : raw.address(e.x, e.y);
+    }
+
+    /// Get the pixel of the (distorted) input mask that's imaged at the given
+    /// pixel, or an invalid pixel if it falls outside of the camera image.
+    Pixel source(uint x, uint y) const {
+        Entry e = remap[y * W + x];
+        return e.x == OUTSIDE ? Pixel() : Pixel(e.x, e.y);
+    }
+
+    /// The coordinates are undistorted, not those of the input mask.
+    constexpr static bool REMAPS = true;
+
+    /// Convert undistorted coordinates to coordinates in the camera image.
+    static Point distort(Point p) {
+        float x = (p.x - Lens::CENTER_X) / Lens::FOCAL_LENGTH;
+        float y = (p.y - Lens::CENTER_Y) / Lens::FOCAL_LENGTH;
+        float s = scale(x * x + y * y);
+        return {Lens::CENTER_X + Lens::FOCAL_LENGTH * x * s,
+                Lens::CENTER_Y + Lens::FOCAL_LENGTH * y * s};
+    }
+
+    /// Convert coordinates in the camera image to undistorted coordinates.
+    /// The radial model has no closed-form inverse, so it's solved by
+    /// fixed-point iteration, which converges quickly for realistic lenses.
+    static Point undistort(Point p) {
+        const float xd = (p.x - Lens::CENTER_X) / Lens::FOCAL_LENGTH;
+        const float yd = (p.y - Lens::CENTER_Y) / Lens::FOCAL_LENGTH;
+        float x = xd, y = yd;
+        for (uint i = 0; i < UNDISTORT_ITERATIONS; ++i) {
+            float s = scale(x * x + y * y);
+            x       = xd / s;
+            y       = yd / s;
+        }
+        return {Lens::CENTER_X + Lens::FOCAL_LENGTH * x,
+                Lens::CENTER_Y + Lens::FOCAL_LENGTH * y};
+    }
+
+  private:
+    /// The number of iterations used by #undistort.
+    constexpr static uint UNDISTORT_ITERATIONS = 20;
+    /// Marks undistorted pixels that fall outside of the camera image.
+    constexpr static uint16_t OUTSIDE = 0xFFFF;
+
+    /// The pixel of the camera image that's imaged at an undistorted pixel.
+    struct Entry {
+        uint16_t x, y;
+    };
+
+    /// The remap table, row by row, built once when it's first used.
+    struct Table {
+        Table() {
+            for (uint y = 0; y < H; ++y) {
+                for (uint x = 0; x < W; ++x) {
+                    Point d = distort({float(x), float(y)});
+                    long dx = std::lround(d.x), dy = std::lround(d.y);
+                    bool in = dx >= 0 && dx < long(W) && dy >= 0 &&
+                              dy < long(H);
+                    entries[y * W + x] = in ? Entry{uint16_t(dx), uint16_t(dy)}
+                                            : Entry{OUTSIDE, OUTSIDE};
+                }
+            }
+        }
+        std::array<Entry, W * H> entries;
+    };
+
+    static const Table &table() {
+        static const Table t;
+        return t;
+    }
+
+    /// The factor by which the lens scales the distance to the center.
+    static float scale(float r2) {
+        return 1 + r2 * (Lens::K1 + r2 * Lens::K2);
+    }
+
+    Inner raw;
+    /// Points to the entries of the shared table, so #get doesn't have to
+    /// check whether the table was initialized.
+    const Entry *remap;
+};
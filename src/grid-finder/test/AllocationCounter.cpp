@@ -0,0 +1,20 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<size_t> AllocationCounter::count = 0;
+
+void *operator new(size_t size) {
+    ++AllocationCounter::count;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
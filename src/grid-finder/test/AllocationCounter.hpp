@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief   Counts the number of calls to the global `operator new`, so tests
+ *          can check that a piece of code doesn't allocate any memory on the
+ *          heap.
+ *
+ * The replacement allocation functions are defined in AllocationCounter.cpp.
+ */
+namespace AllocationCounter {
+
+/// The total number of heap allocations so far.
+extern std::atomic<size_t> count;
+
+/// Counts the number of heap allocations during its lifetime.
+class Scope {
+  public:
+    Scope() : start(count.load()) {}
+    size_t getCount() const { return count.load() - start; }
+
+  private:
+    size_t start;
+};
+
+}  // namespace AllocationCounter
@@ -0,0 +1,6 @@
+// The test mask that's shared by all test files, which declare it as
+// `extern TMatrix<uint8_t, 308, 410> mask;`.
+
+#include <Matrix.hpp>
+#include <cstdint>
+#include "TestMask.hpp"
@@ -0,0 +1,8 @@
+#include <BitScan.hpp>
+#include <gtest/gtest.h>
+
+TEST(BitScan, countTrailingZeros) {
+    EXPECT_EQ(countTrailingZeros(uint32_t(1)), 0);
+    EXPECT_EQ(countTrailingZeros(uint32_t(0b101000)), 3);
+    EXPECT_EQ(countTrailingZeros(uint32_t(1) << 31), 31);
+}
@@ -162,4 +162,13 @@ TEST(BresenhamLine, lowPosXNegY) {
     };
 
     ASSERT_EQ(result, expect);
-}
\ No newline at end of file
+}
+TEST(BresenhamLine, lookahead) {
+    BresenhamLine line = {{4, 8}, atan2(-2, 1), 20, 20};
+    Pixel offset       = line.getLookahead(4);
+    Pixel start        = line.peek();
+    for (uint i = 0; i < 4; ++i)
+        line.next();
+    Pixel expect = {start.x + offset.x, start.y + offset.y};
+    ASSERT_EQ(line.peek(), expect);
+}
@@ -0,0 +1,60 @@
+#include <GridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+using GF = GridFinder<410, 308>;
+
+TEST(Confidence, square) {
+    auto gf             = std::make_unique<GF>(mask);
+    Square sq           = gf->findSquare();
+    const uint minVotes = GF::Parameters_t::MINIMIM_LINE_WEIGHTED_VOTE_COUNT;
+    for (const auto &line : sq.lines) {
+        ASSERT_TRUE(line.has_value());
+        EXPECT_GE(line->votes, minVotes);
+        EXPECT_GT(line->confidence, 0.5);
+        EXPECT_LE(line->confidence, 1);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(sq.points[i].has_value());
+        EXPECT_GT(sq.pointConfidence[i], 0.25) << i;
+        EXPECT_LE(sq.pointConfidence[i], 1) << i;
+    }
+}
+
+TEST(Confidence, notFound) {
+    auto gf   = std::make_unique<GF>();
+    Square sq = gf->findSquare();
+    for (float c : sq.pointConfidence)
+        EXPECT_EQ(c, 0);
+}
+
+TEST(Confidence, factors) {
+    auto gf              = std::make_unique<GF>(mask);
+    const uint minVotes  = GF::Parameters_t::MINIMIM_LINE_WEIGHTED_VOTE_COUNT;
+    const uint range     = 9;
+    GetMiddleResult even = {{100, 100}, 10, 0};
+    // Perfect line
+    EXPECT_FLOAT_EQ(gf->lineConfidence({{0.0, 2 * minVotes}, 1}, range, even),
+                    1);
+    // Exactly at the threshold
+    EXPECT_FLOAT_EQ(gf->lineConfidence({{0.0, minVotes}, 1}, range, even),
+                    0.5);
+    // The peak covers the entire range
+    EXPECT_FLOAT_EQ(
+        gf->lineConfidence({{0.0, 2 * minVotes}, 2 * range + 1}, range, even),
+        0);
+    // The widths on both sides differ by half of the width
+    GetMiddleResult uneven = {{100, 100}, 10, 5};
+    EXPECT_FLOAT_EQ(
+        gf->lineConfidence({{0.0, 2 * minVotes}, 1}, range, uneven), 0.5);
+}
+
+TEST(Confidence, corners) {
+    LineResult horizontal = {{0, 0}, 5, angle_t(0.0), 0, 0.5};
+    LineResult vertical   = {{0, 0}, 5, angle_t(M_PI / 2), 0, 0.5};
+    LineResult opposite   = {{0, 0}, 5, angle_t(M_PI), 0, 1};
+    EXPECT_NEAR(GF::cornerConfidence(horizontal, vertical), 0.25, 1e-6);
+    EXPECT_NEAR(GF::cornerConfidence(horizontal, opposite), 0, 1e-6);
+}
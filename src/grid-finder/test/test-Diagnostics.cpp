@@ -0,0 +1,68 @@
+#include <Diagnostics.hpp>
+#include <GridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+TEST(DiagnosticsRing, pushAndDrain) {
+    DiagnosticsRing<4> ring;
+    for (uint i = 0; i < 6; ++i)
+        ring.push({DiagnosticEvent::LineRejectedWidth, {i, 0}, {}, i});
+    EXPECT_EQ(ring.size(), 4);
+    EXPECT_EQ(ring.getDroppedCount(), 2);
+
+    std::vector<uint> values;
+    auto collect = [&](const Diagnostic &d) { values.push_back(d.value); };
+    EXPECT_EQ(ring.drain(collect), 4);
+    EXPECT_EQ(values, (std::vector<uint>{0, 1, 2, 3}));
+    EXPECT_EQ(ring.size(), 0);
+
+    // The ring wraps around
+    EXPECT_TRUE(ring.push({DiagnosticEvent::Error, {}, {}, 42}));
+    values.clear();
+    ring.drain(collect);
+    EXPECT_EQ(values, (std::vector<uint>{42}));
+}
+
+TEST(DiagnosticsRing, concurrentDrain) {
+    constexpr uint N = 100000;
+    auto ring        = std::make_unique<DiagnosticsRing<64>>();
+    std::thread producer([&] {
+        for (uint i = 0; i < N; ++i)
+            ring->push({DiagnosticEvent::RetriesExhausted, {}, {}, i});
+    });
+    // Events must arrive in order, without duplicates
+    uint received = 0, last = 0;
+    bool ordered  = true;
+    auto check    = [&](const Diagnostic &d) {
+        ordered &= received == 0 || d.value > last;
+        last = d.value;
+        ++received;
+    };
+    while (received + ring->getDroppedCount() < N)
+        ring->drain(check);
+    producer.join();
+    ring->drain(check);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received + ring->getDroppedCount(), N);
+}
+
+TEST(Diagnostics, rejectedLines) {
+    using Params  = RuntimeParameters<410, 308>;
+    Params params = {};
+    // The lines in the test mask are narrower than this
+    params.MINIMUM_START_LINE_WIDTH = 30;
+    auto gf = std::make_unique<GridFinder<410, 308, Params>>(mask, params);
+    gf->findSquare();
+    size_t widthRejections = 0;
+    gf->getDiagnostics().drain([&](const Diagnostic &d) {
+        if (d.event == DiagnosticEvent::LineRejectedWidth) {
+            EXPECT_LT(d.value, 30);
+            ++widthRejections;
+        }
+    });
+    EXPECT_GT(widthRejections, 0);
+}
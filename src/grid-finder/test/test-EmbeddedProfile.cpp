@@ -0,0 +1,87 @@
+// Compiled with GRID_FINDER_EMBEDDED=1 and -fno-exceptions, in a separate
+// test executable (see CMakeLists.txt).
+
+#include <GridFinder.hpp>
+#include "AllocationCounter.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+static_assert(GRID_FINDER_EMBEDDED && !GRID_FINDER_EXCEPTIONS &&
+              !GRID_FINDER_IOSTREAM);
+
+using GF        = GridFinder<410, 308>;
+using Params    = RuntimeParameters<410, 308>;
+using RuntimeGF = GridFinder<410, 308, Params>;
+
+TEST(EmbeddedProfile, findSquare) {
+    auto gf = std::make_unique<GF>(mask);
+    AllocationCounter::Scope allocations;
+    Square sq = gf->findSquare();
+    EXPECT_EQ(allocations.getCount(), 0);
+    EXPECT_EQ(sq.status, SearchStatus::Ok);
+    EXPECT_FALSE(sq.truncated);
+    for (const auto &p : sq.points)
+        EXPECT_TRUE(p.has_value());
+}
+
+TEST(EmbeddedProfile, invalidParameters) {
+    Params params = {};
+    params.MAX_LINE_WIDTH = 0;
+    auto gf   = std::make_unique<RuntimeGF>(mask, params);
+    Square sq = gf->findSquare();
+    EXPECT_EQ(sq.status, SearchStatus::InvalidParameters);
+    EXPECT_FALSE(sq.lines[0].has_value());
+    EXPECT_FALSE(RuntimeGF::checkParameters(params));
+    EXPECT_STREQ(RuntimeGF::getParameterError(params),
+                 "Error: MAX_LINE_WIDTH must be positive");
+
+    gf->setParameters({});
+    sq = gf->findSquare();
+    EXPECT_EQ(sq.status, SearchStatus::Ok);
+    EXPECT_TRUE(sq.points[3].has_value());
+}
+
+TEST(EmbeddedProfile, setInvalidParameters) {
+    auto gf       = std::make_unique<RuntimeGF>(mask);
+    Params params = {};
+    params.HOUGH_ANGLE_STEP = 0;
+    gf->setParameters(params);
+    // The invalid parameters are not applied
+    EXPECT_EQ(gf->getParameters().HOUGH_ANGLE_STEP, Params{}.HOUGH_ANGLE_STEP);
+    EXPECT_EQ(gf->findSquare().status, SearchStatus::InvalidParameters);
+}
+
+TEST(EmbeddedProfile, outOfRange) {
+    auto gf = std::make_unique<GF>(mask);
+    EXPECT_FALSE(gf->getFirstLineEstimate(410).has_value());
+    EXPECT_FALSE(gf->findLineAngleAccurateRange({200, 57}, angle_t(0u),
+                                                angle_t::resolution())
+                     .has_value());
+}
+
+TEST(EmbeddedProfile, nextLineOutsideRegion) {
+    auto gf = std::make_unique<GF>(mask);
+    gf->setRegionOfInterest({100, 100, 50, 50});
+    // The search path starts outside of the region of interest
+    LineResult line = {{10, 10}, 5, angle_t(0u)};
+    EXPECT_FALSE(gf->findNextLine(line, true).has_value());
+    EXPECT_FALSE(gf->findNextLine(line, false).has_value());
+}
+
+TEST(EmbeddedProfile, houghBatchSizeMismatch) {
+    auto gf = std::make_unique<GF>(mask);
+    std::array<Pixel, 2> pixels;
+    std::array<angle_t, 3> angles;
+    std::array<HoughResult, 3> results;
+    results.fill({angle_t(1u), 42});
+    gf->houghBatch(pixels, angles, results);
+    for (HoughResult h : results)
+        EXPECT_EQ(h.count, 0);
+}
+
+TEST(EmbeddedProfile, statusNames) {
+    EXPECT_STREQ(toString(SearchStatus::Ok), "Ok");
+    EXPECT_STREQ(toString(SearchStatus::OutOfRange), "Out of range");
+}
@@ -0,0 +1,63 @@
+#include <Degrees.hpp>
+#include <FixedPointLine.hpp>
+#include <Line.hpp>
+#include <gtest/gtest.h>
+
+TEST(FixedPointLine, pointRelativePosition) {
+    Pixel point       = {5, 5};
+    FixedPointLine l1 = {{7, 3}, angle_t(225_deg)};
+    FixedPointLine l2 = {{3, 7}, angle_t(45_deg)};
+    FixedPointLine r1 = {{7, 3}, angle_t(45_deg)};
+    FixedPointLine r2 = {{3, 7}, angle_t(225_deg)};
+
+    EXPECT_TRUE(l1.rightOfPoint(point));
+    EXPECT_TRUE(l2.rightOfPoint(point));
+    EXPECT_FALSE(r1.rightOfPoint(point));
+    EXPECT_FALSE(r2.rightOfPoint(point));
+}
+
+TEST(FixedPointLine, intersectExact) {
+    FixedPointLine a = {{100, 50}, angle_t(0_deg)};
+    FixedPointLine b = {{30, 200}, angle_t(90_deg)};
+    std::optional<FixedPoint> result = FixedPointLine::intersect(a, b);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, (FixedPoint{30 << 8, 50 << 8}));
+}
+
+TEST(FixedPointLine, intersectParallel) {
+    FixedPointLine a = {{100, 50}, angle_t(30_deg)};
+    FixedPointLine b = {{30, 200}, angle_t(30_deg)};
+    EXPECT_FALSE(FixedPointLine::intersect(a, b).has_value());
+}
+
+/// Compare to the floating point version for lines of a grid at all angles.
+TEST(FixedPointLine, sameAsFloat) {
+    const Pixel pixels[] = {{0, 0}, {205, 154}, {409, 20}, {12, 307},
+                            {1919, 1079}, {960, 540}};
+    for (uint i = 0; i < angle_t::resolution(); ++i) {
+        for (uint delta : {60u, 90u, 120u}) {
+            angle_t angleA = angle_t(i);
+            angle_t angleB = angle_t(i) + angle_t(delta);
+            for (Pixel pa : pixels) {
+                for (Pixel pb : pixels) {
+                    Point expected = Line::intersect({pa, angleA}, {pb, angleB});
+                    Point result =
+                        FixedPointLine::intersect({pa, angleA}, {pb, angleB})
+                            ->toPoint();
+                    ASSERT_NEAR(result.x, expected.x, 1.0 / 64)
+                        << i << " " << pa << " " << pb;
+                    ASSERT_NEAR(result.y, expected.y, 1.0 / 64)
+                        << i << " " << pa << " " << pb;
+                }
+                // Same side of the line, for points that are not on the line
+                Line line                = {pa, angleA};
+                FixedPointLine fixedLine = {pa, angleA};
+                for (Pixel p : pixels) {
+                    if (std::abs(fixedLine.signedDistance(p)) < (1 << 14))
+                        continue;
+                    ASSERT_EQ(fixedLine.leftOfPoint(p), line.leftOfPoint(p));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include <GridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+using GF        = GridFinder<410, 308>;
+using Params    = RuntimeParameters<410, 308>;
+using RuntimeGF = GridFinder<410, 308, Params>;
+
+TEST(OccupancyMap, counts) {
+    auto occupancy = std::make_unique<OccupancyMap<410, 308>>(mask);
+    // Brute force count of the white pixels in a region aligned to the cells
+    auto countWhite = [](Rect r) {
+        uint count = 0;
+        for (uint y = r.y; y < r.y + r.height; ++y)
+            for (uint x = r.x; x < r.x + r.width; ++x)
+                count += mask[y][x] != 0;
+        return count;
+    };
+    Rect full             = {0, 0, 410, 308};
+    OccupancySummary all  = occupancy->summarize(full);
+    EXPECT_EQ(all.white, countWhite(full));
+    EXPECT_EQ(all.area, 410 * 308);
+    Rect cells            = {32, 48, 64, 80};
+    OccupancySummary part = occupancy->summarize(cells);
+    EXPECT_EQ(part.white, countWhite(cells));
+    EXPECT_EQ(part.area, 64 * 80);
+    // Unaligned regions include the cells on their edges
+    EXPECT_EQ(occupancy->summarize({33, 49, 62, 78}).white, part.white);
+}
+
+TEST(OccupancyMap, set) {
+    auto gf = std::make_unique<GF>();
+    gf->set({100, 100});
+    gf->set({100, 100});  // setting a white pixel again changes nothing
+    gf->set({300, 200});
+    OccupancySummary s = gf->getOccupancy().summarize({0, 0, 410, 308});
+    EXPECT_EQ(s.white, 2);
+    EXPECT_EQ(s.extentX, 13 * 16);  // cells 6 to 18
+    EXPECT_EQ(s.extentY, 7 * 16);   // cells 6 to 12
+    gf->set({300, 200}, 0x00);
+    EXPECT_EQ(gf->getOccupancy().getCount(300, 200), 0);
+}
+
+TEST(FrameCheck, grid) {
+    auto gf = std::make_unique<GF>(mask);
+    EXPECT_EQ(gf->checkFrame(), SearchStatus::Ok);
+    EXPECT_EQ(gf->findSquare().status, SearchStatus::Ok);
+}
+
+TEST(FrameCheck, dark) {
+    auto gf   = std::make_unique<GF>();
+    Square sq = gf->findSquare();
+    EXPECT_EQ(sq.status, SearchStatus::TooFewPixels);
+    EXPECT_FALSE(sq.lines[0].has_value());
+    EXPECT_EQ(gf->getStepCount(), 0);
+    size_t rejections = 0;
+    gf->getDiagnostics().drain([&](const Diagnostic &d) {
+        EXPECT_EQ(d.event, DiagnosticEvent::FrameRejected);
+        EXPECT_EQ(d.value, uint(SearchStatus::TooFewPixels));
+        ++rejections;
+    });
+    EXPECT_EQ(rejections, 1);
+}
+
+TEST(FrameCheck, overexposed) {
+    auto white = std::make_unique<GF::Img_t>();
+    for (auto &row : *white)
+        for (auto &px : row)
+            px = 0xFF;
+    auto gf = std::make_unique<GF>(*white);
+    EXPECT_EQ(gf->findSquare().status, SearchStatus::TooManyPixels);
+
+    // The check can be disabled
+    Params params                   = {};
+    params.MAXIMUM_WHITE_PERCENTAGE = 100;
+    auto runtime = std::make_unique<RuntimeGF>(*white, params);
+    EXPECT_EQ(runtime->checkFrame(), SearchStatus::Ok);
+    EXPECT_EQ(runtime->findSquare().status, SearchStatus::Ok);
+}
+
+TEST(FrameCheck, blob) {
+    auto gf = std::make_unique<GF>();
+    for (uint y = 150; y < 170; ++y)
+        for (uint x = 200; x < 220; ++x)
+            gf->set({x, y});
+    EXPECT_EQ(gf->findSquare().status, SearchStatus::NoStructure);
+}
+
+TEST(FrameCheck, regionOfInterest) {
+    auto gf = std::make_unique<GF>(mask);
+    // Only black pixels in this corner of the test mask
+    gf->setRegionOfInterest({0, 0, 16, 16});
+    EXPECT_EQ(gf->checkFrame(), SearchStatus::TooFewPixels);
+    gf->resetRegionOfInterest();
+    EXPECT_EQ(gf->checkFrame(), SearchStatus::Ok);
+}
+
+TEST(FrameCheck, invalidPercentage) {
+    Params params                   = {};
+    params.MAXIMUM_WHITE_PERCENTAGE = 101;
+    EXPECT_STREQ(RuntimeGF::getParameterError(params),
+                 "Error: MAXIMUM_WHITE_PERCENTAGE must be at most 100");
+}
+
+TEST(FrameCheck, setMask) {
+    auto gf = std::make_unique<GF>();
+    EXPECT_EQ(gf->checkFrame(), SearchStatus::TooFewPixels);
+    gf->setMask(mask);
+    EXPECT_EQ(gf->checkFrame(), SearchStatus::Ok);
+    Square sq       = gf->findSquare();
+    Square expected = std::make_unique<GF>(mask)->findSquare();
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(sq.points[i], expected.points[i]);
+}
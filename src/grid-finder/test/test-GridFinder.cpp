@@ -330,7 +330,7 @@ TEST(GridFinder, findLineAngleAccurateRange110) {
 
     double result =
         gm.findLineAngleAccurateRange<angle_t::resolution() / 8>(center, angle)
-            .angle.rad();
+            ->angle.rad();
     double expect = angle;
 
     EXPECT_NEAR(result, expect, angle_t::step());
@@ -350,7 +350,7 @@ TEST(GridFinder, findLineAngleAccurateRange20) {
 
     double result =
         gm.findLineAngleAccurateRange<angle_t::resolution() / 8>(center, angle)
-            .angle.rad();
+            ->angle.rad();
     double expect = angle;
 
     EXPECT_NEAR(result, expect, angle_t::step());
@@ -370,7 +370,7 @@ TEST(GridFinder, findLineAngleAccurateRange340) {
 
     angle_t result =
         gm.findLineAngleAccurateRange<angle_t::resolution() / 8>(center, angle)
-            .angle;
+            ->angle;
     angle_t expect = angle;
 
     EXPECT_EQ(result, expect);
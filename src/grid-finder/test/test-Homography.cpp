@@ -0,0 +1,86 @@
+#include <GridFinder.hpp>
+#include <Homography.hpp>
+#include <PyramidGridFinder.hpp>
+#include <array>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+/// A perspective view of the grid: maps grid coordinates to the image.
+static Point project(Point g) {
+    float w = 0.001f * g.x - 0.002f * g.y + 1;
+    return {(90 * g.x + 15 * g.y + 120) / w, (-10 * g.x + 80 * g.y + 60) / w};
+}
+
+static void expectNear(Point a, Point b, float tolerance = 1e-3f) {
+    EXPECT_NEAR(a.x, b.x, tolerance);
+    EXPECT_NEAR(a.y, b.y, tolerance);
+}
+
+TEST(Homography, fourPoints) {
+    std::array<PointPair, 4> pairs;
+    const Point grid[4] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+    for (size_t i = 0; i < 4; ++i)
+        pairs[i] = {project(grid[i]), grid[i]};
+    auto h = Homography::fit(pairs);
+    ASSERT_TRUE(h.has_value());
+    EXPECT_FLOAT_EQ(h->matrix[2][2], 1);
+    for (const PointPair &pair : pairs)
+        expectNear(h->map(pair.image), pair.grid);
+    // Points that weren't used for the fit are mapped correctly as well
+    expectNear(h->map(project({2, -1})), {2, -1});
+}
+
+TEST(Homography, allIntersections) {
+    std::vector<PointPair> pairs;
+    for (int v = -2; v <= 2; ++v)
+        for (int u = -2; u <= 2; ++u)
+            pairs.push_back({project({float(u), float(v)}),
+                             {float(u), float(v)}});
+    auto h = Homography::fit({pairs.data(), pairs.size()});
+    ASSERT_TRUE(h.has_value());
+    for (const PointPair &pair : pairs)
+        expectNear(h->map(pair.image), pair.grid);
+}
+
+TEST(Homography, degenerate) {
+    std::array<PointPair, 4> collinear = {{
+        {{0, 0}, {0, 0}},
+        {{1, 1}, {1, 0}},
+        {{2, 2}, {0, 1}},
+        {{3, 3}, {1, 1}},
+    }};
+    EXPECT_FALSE(Homography::fit(collinear).has_value());
+    std::array<PointPair, 3> tooFew = {{
+        {{0, 0}, {0, 0}},
+        {{1, 0}, {1, 0}},
+        {{0, 1}, {0, 1}},
+    }};
+    EXPECT_FALSE(Homography::fit(tooFew).has_value());
+}
+
+TEST(Homography, findSquare) {
+    using GF  = GridFinder<410, 308>;
+    auto gf   = std::make_unique<GF>(mask);
+    Square sq = gf->findSquare();
+    ASSERT_TRUE(sq.homography.has_value());
+    const Point grid[4] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+    for (size_t i = 0; i < 4; ++i)
+        expectNear(sq.homography->map(*sq.points[i]), grid[i]);
+
+    // No homography without all four points
+    Square partial = sq;
+    partial.points[3].reset();
+    EXPECT_FALSE(GF::squareHomography(partial).has_value());
+}
+
+TEST(Homography, pyramidFindSquare) {
+    auto pyramid = std::make_unique<PyramidGridFinder<410, 308, 2>>(mask);
+    Square sq    = pyramid->findSquare();
+    ASSERT_TRUE(sq.homography.has_value());
+    const Point grid[4] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+    for (size_t i = 0; i < 4; ++i)
+        expectNear(sq.homography->map(*sq.points[i]), grid[i]);
+}
@@ -0,0 +1,39 @@
+#include <GridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+using GF = GridFinder<410, 308>;
+
+template <uint BatchSize>
+static void expectSameAsHough() {
+    auto gf = std::make_unique<GF>(mask);
+    std::array<Pixel, 2 * angle_t::resolution()> pixels;
+    std::array<angle_t, 2 * angle_t::resolution()> angles;
+    std::array<HoughResult, 2 * angle_t::resolution()> results;
+    for (uint i = 0; i < angles.size(); ++i) {
+        pixels[i] = i % 2 ? Pixel{200, 57} : Pixel{5, 300};
+        angles[i] = angle_t(i % angle_t::resolution());
+    }
+    gf->houghBatch<BatchSize>(pixels, angles, results);
+    auto expected = std::make_unique<GF>(mask);
+    for (uint i = 0; i < angles.size(); ++i) {
+        HoughResult h = expected->hough(pixels[i], angles[i]);
+        EXPECT_EQ(results[i].angle, h.angle) << i;
+        EXPECT_EQ(results[i].count, h.count) << i;
+    }
+}
+
+TEST(HoughBatch, sameAsHough1) { expectSameAsHough<1>(); }
+TEST(HoughBatch, sameAsHough3) { expectSameAsHough<3>(); }
+TEST(HoughBatch, sameAsHough8) { expectSameAsHough<8>(); }
+
+TEST(HoughBatch, sizeMismatch) {
+    auto gf = std::make_unique<GF>(mask);
+    std::array<Pixel, 2> pixels;
+    std::array<angle_t, 3> angles;
+    std::array<HoughResult, 3> results;
+    EXPECT_THROW(gf->houghBatch(pixels, angles, results),
+                 std::invalid_argument);
+}
@@ -0,0 +1,58 @@
+#include <GridFinder.hpp>
+#include <HoughCache.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+TEST(HoughCache, lookupAndClear) {
+    HoughCache<16> cache;
+    uint count = 0;
+    EXPECT_FALSE(cache.lookup({1, 2}, 3, count));
+    cache.insert({1, 2}, 3, 42);
+    cache.insert({2, 1}, 3, 43);
+    ASSERT_TRUE(cache.lookup({1, 2}, 3, count));
+    EXPECT_EQ(count, 42);
+    ASSERT_TRUE(cache.lookup({2, 1}, 3, count));
+    EXPECT_EQ(count, 43);
+    EXPECT_FALSE(cache.lookup({1, 2}, 4, count));
+    EXPECT_EQ(cache.getStats().hits, 2);
+    EXPECT_EQ(cache.getStats().misses, 2);
+    EXPECT_DOUBLE_EQ(cache.getStats().hitRate(), 0.5);
+
+    cache.clear();
+    EXPECT_FALSE(cache.lookup({1, 2}, 3, count));
+}
+
+TEST(HoughCache, full) {
+    HoughCache<8> cache;
+    for (uint i = 0; i < 100; ++i)
+        cache.insert({i, i}, i, i);
+    // The most recent entry is always available
+    uint count = 0;
+    ASSERT_TRUE(cache.lookup({99, 99}, 99, count));
+    EXPECT_EQ(count, 99);
+}
+
+TEST(HoughCache, gridFinder) {
+    using GF      = GridFinder<410, 308>;
+    auto gf       = std::make_unique<GF>(mask);
+    Square sq     = gf->findSquare();
+    auto line     = *sq.lines[2];
+    auto expected = gf->findLineAngleAccurateRange<9>(line.lineCenter, //
+                                                      line.angle);
+    auto stats    = gf->getHoughCacheStats();
+    auto result   = gf->findLineAngleAccurateRange<9>(line.lineCenter, //
+                                                    line.angle);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->angle, expected->angle);
+    EXPECT_EQ(result->count, expected->count);
+    EXPECT_EQ(gf->getHoughCacheStats().hits, stats.hits + 2 * 9 + 1);
+
+    // Changing the mask invalidates the cache
+    gf->set(line.lineCenter, 0x00);
+    stats = gf->getHoughCacheStats();
+    gf->findLineAngleAccurateRange<9>(line.lineCenter, line.angle);
+    EXPECT_EQ(gf->getHoughCacheStats().hits, stats.hits);
+}
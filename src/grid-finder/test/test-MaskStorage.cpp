@@ -0,0 +1,146 @@
+#include <GridFinder.hpp>
+#include <MaskStorage.hpp>
+#include <UndistortedStorage.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+using Params  = DefaultParameters<410, 308>;
+using GF      = GridFinder<410, 308>;
+using TiledGF = GridFinder<410, 308, Params, TiledStorage<410, 308>>;
+
+/// A camera without distortion.
+struct PinholeLens {
+    constexpr static float K1           = 0;
+    constexpr static float K2           = 0;
+    constexpr static float CENTER_X     = 204.5;
+    constexpr static float CENTER_Y     = 153.5;
+    constexpr static float FOCAL_LENGTH = 300;
+};
+/// A wide-angle camera with strong barrel distortion.
+struct WideLens : PinholeLens {
+    constexpr static float K1 = -0.25;
+    constexpr static float K2 = 0.05;
+};
+using PinholeStorage = UndistortedStorage<410, 308, PinholeLens>;
+using WideStorage    = UndistortedStorage<410, 308, WideLens>;
+
+TEST(MaskStorage, tiledGetSet) {
+    auto storage = std::make_unique<TiledStorage<410, 308>>(mask);
+    for (uint y = 0; y < 308; ++y)
+        for (uint x = 0; x < 410; ++x)
+            ASSERT_EQ(storage->get(x, y), mask[y][x]);
+    storage->set(409, 307, 0x42);
+    EXPECT_EQ(storage->get(409, 307), 0x42);
+    EXPECT_EQ(storage->get(408, 307), mask[307][408]);
+}
+
+TEST(MaskStorage, tiledFindSquare) {
+    auto gf         = std::make_unique<GF>(mask);
+    auto tiled      = std::make_unique<TiledGF>(mask);
+    Square expected = gf->findSquare();
+    Square result   = tiled->findSquare();
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(result.points[i], expected.points[i]);
+    EXPECT_EQ(tiled->getStepCount(), gf->getStepCount());
+}
+
+TEST(MaskStorage, undistortedWithoutDistortion) {
+    auto gf         = std::make_unique<GF>(mask);
+    auto pinhole    = std::make_unique<GridFinder<410, 308, Params,
+                                                  PinholeStorage>>(mask);
+    Square expected = gf->findSquare();
+    Square result   = pinhole->findSquare();
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(result.points[i], expected.points[i]);
+    EXPECT_EQ(pinhole->getStepCount(), gf->getStepCount());
+}
+
+TEST(MaskStorage, undistortRoundTrip) {
+    for (Point p : {Point{0, 0}, Point{409, 0}, Point{100, 250}}) {
+        Point q = WideStorage::distort(WideStorage::undistort(p));
+        EXPECT_NEAR(q.x, p.x, 0.01);
+        EXPECT_NEAR(q.y, p.y, 0.01);
+    }
+    Point center = WideStorage::distort({204.5, 153.5});
+    EXPECT_FLOAT_EQ(center.x, 204.5);
+    EXPECT_FLOAT_EQ(center.y, 153.5);
+}
+
+/// The distance from the center line of the nearest grid line, for a grid at
+/// an angle of 0.2 rad, with lines 9 pixels wide and 120 pixels apart.
+static float gridDistance(float d) {
+    return std::abs(std::fmod(d + 1200 - 4, 120.f) - 60) - 60;
+}
+
+TEST(MaskStorage, undistortedFindSquare) {
+    // A straight grid, as seen through a wide-angle lens
+    auto distorted  = std::make_unique<TMatrix<uint8_t, 308, 410>>();
+    const float cos = std::cos(0.2f), sin = std::sin(0.2f);
+    for (uint y = 0; y < 308; ++y) {
+        for (uint x = 0; x < 410; ++x) {
+            Point p = WideStorage::undistort({float(x), float(y)});
+            float u = p.x * cos + p.y * sin, v = p.y * cos - p.x * sin;
+            bool on = -gridDistance(u) < 4.5f || -gridDistance(v) < 4.5f;
+            (*distorted)[y][x] = on ? 0xFF : 0;
+        }
+    }
+    auto gf = std::make_unique<GridFinder<410, 308, Params, WideStorage>>(
+        *distorted);
+    Square sq = gf->findSquare();
+    ASSERT_EQ(sq.status, SearchStatus::Ok);
+    // The corners are intersections of the straight grid lines, in
+    // undistorted coordinates
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(sq.points[i].has_value());
+        Point p = *sq.points[i];
+        EXPECT_GT(gridDistance(p.x * cos + p.y * sin), -2) << i;
+        EXPECT_GT(gridDistance(p.y * cos - p.x * sin), -2) << i;
+    }
+}
+
+TEST(MaskStorage, undistortedOccupancy) {
+    auto empty   = std::make_unique<TMatrix<uint8_t, 308, 410>>();
+    auto storage = std::make_unique<WideStorage>(*empty);
+    auto gf = std::make_unique<GridFinder<410, 308, Params, WideStorage>>(
+        *empty);
+    // Find two undistorted pixels that are imaged at the same mask pixel (the
+    // lens compresses the edges of the image, so there are many near the top)
+    auto aliases = [&](Pixel a, Pixel b) {
+        Pixel src = storage->source(a.x, a.y);
+        return src.isValid() && src == storage->source(b.x, b.y);
+    };
+    Pixel a = {0, 20}, b = {1, 20};
+    while (b.x < 410 && !aliases(a, b))
+        a = b, ++b.x;
+    ASSERT_LT(b.x, 410);
+    Pixel src = storage->source(a.x, a.y);
+    // Setting the pixel through one alias and clearing it through the other
+    // leaves the count of its cell at zero
+    gf->set(a, 0xFF);
+    gf->set(b, 0xFF);
+    EXPECT_EQ(gf->getOccupancy().getCount(src.x, src.y), 1);
+    gf->set(b, 0x00);
+    EXPECT_EQ(gf->getOccupancy().getCount(src.x, src.y), 0);
+    gf->set(a, 0x00);
+    EXPECT_EQ(gf->getOccupancy().getCount(src.x, src.y), 0);
+}
+
+TEST(MaskStorage, undistortedRegionOfInterest) {
+    // All white pixels are in the top left corner of the input mask
+    auto corner = std::make_unique<TMatrix<uint8_t, 308, 410>>();
+    for (uint y = 0; y < 100; ++y)
+        for (uint x = 0; x < 100; ++x)
+            (*corner)[y][x] = (x / 10 + y / 10) % 2 ? 0xFF : 0;
+    auto gf = std::make_unique<GridFinder<410, 308, Params, WideStorage>>(
+        *corner);
+    // The region of interest is in undistorted coordinates, which don't match
+    // the cells of the occupancy map, so the entire frame is checked
+    const SearchStatus full = gf->checkFrame();
+    gf->setRegionOfInterest({300, 200, 100, 100});
+    EXPECT_EQ(gf->checkFrame(), full);
+    gf->setRegionOfInterest({0, 0, 120, 120});
+    EXPECT_EQ(gf->checkFrame(), full);
+}
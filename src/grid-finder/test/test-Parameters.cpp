@@ -0,0 +1,80 @@
+#include <GridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+using GF        = GridFinder<410, 308>;
+using Params    = RuntimeParameters<410, 308>;
+using RuntimeGF = GridFinder<410, 308, Params>;
+
+static Params readProfile(const std::string &profile) {
+    std::istringstream is = std::istringstream(profile);
+    return readParameters<410, 308>(is);
+}
+
+TEST(Parameters, runtimeDefaultsMatchConstants) {
+    auto gf         = std::make_unique<GF>(mask);
+    auto runtime    = std::make_unique<RuntimeGF>(mask);
+    Square expected = gf->findSquare();
+    Square result   = runtime->findSquare();
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(result.points[i], expected.points[i]);
+    EXPECT_EQ(runtime->getStepCount(), gf->getStepCount());
+}
+
+TEST(Parameters, runtimeChange) {
+    auto runtime  = std::make_unique<RuntimeGF>(mask);
+    Params params = runtime->getParameters();
+    // The lines in the test mask are narrower than this
+    params.MINIMUM_START_LINE_WIDTH = 30;
+    runtime->setParameters(params);
+    Square result = runtime->findSquare();
+    EXPECT_FALSE(result.lines[0].has_value());
+    EXPECT_EQ(runtime->getParameters().MINIMUM_START_LINE_WIDTH, 30);
+}
+
+TEST(Parameters, invalid) {
+    auto runtime  = std::make_unique<RuntimeGF>(mask);
+    Params params = {};
+    params.FIRST_LINE_INVALID_HORIZONTAL_JUMP = 0;
+    EXPECT_THROW(runtime->setParameters(params), std::invalid_argument);
+    params                      = {};
+    params.ACCURATE_ANGLE_RANGE = angle_t::resolution() / 2;
+    EXPECT_THROW(runtime->setParameters(params), std::invalid_argument);
+}
+
+TEST(Parameters, profile) {
+    Params params               = {};
+    params.HOUGH_MAX_GAP        = 12;
+    params.ACCURATE_ANGLE_RANGE = 5;
+    std::ostringstream profile;
+    profile << params;
+    Params loaded = readProfile(profile.str());
+    EXPECT_EQ(loaded.HOUGH_MAX_GAP, 12);
+    EXPECT_EQ(loaded.ACCURATE_ANGLE_RANGE, 5);
+    EXPECT_EQ(loaded.MAX_LINE_WIDTH, params.MAX_LINE_WIDTH);
+
+    EXPECT_EQ(readProfile("HOUGH_ANGLE_STEP = 3\n").HOUGH_ANGLE_STEP, 3);
+    EXPECT_THROW(readProfile("FOO = 3\n"), std::runtime_error);
+    EXPECT_THROW(readProfile("MAX_GAP 3\n"), std::runtime_error);
+    // Values that don't fit in a uint are rejected instead of wrapping
+    EXPECT_EQ(readProfile("MAX_GAP = 4294967295\n").MAX_GAP, 4294967295u);
+    EXPECT_THROW(readProfile("MAX_GAP = 4294967296\n"), std::runtime_error);
+    EXPECT_THROW(readProfile("MAX_GAP = -1\n"), std::runtime_error);
+}
+
+TEST(Parameters, coarserSearch) {
+    auto runtime                = std::make_unique<RuntimeGF>(mask);
+    Params params               = {};
+    params.HOUGH_ANGLE_STEP     = 2;
+    params.ACCURATE_ANGLE_RANGE = 5;
+    runtime->setParameters(params);
+    Square result = runtime->findSquare();
+    for (const auto &point : result.points)
+        EXPECT_TRUE(point.has_value());
+    auto gf = std::make_unique<GF>(mask);
+    gf->findSquare();
+    EXPECT_LT(runtime->getStepCount(), gf->getStepCount());
+}
@@ -0,0 +1,24 @@
+#include <Bresenham.hpp>
+#include <PerpendicularStencil.hpp>
+#include <gtest/gtest.h>
+
+using Stencils = PerpendicularStencils<angle_t, 40>;
+
+TEST(PerpendicularStencil, sameAsBresenham) {
+    const Pixel start = {50, 50};
+    for (uint i = 0; i < angle_t::resolution(); ++i) {
+        angle_t angle                     = angle_t(i);
+        const Stencils::Stencil &stencil = Stencils::get(angle);
+        for (bool plus90deg : {true, false}) {
+            int sign = plus90deg ? 1 : -1;
+            BresenhamLine line = {start, CosSin(angle).perpendicular(plus90deg),
+                                  100, 100};
+            for (StencilOffset offset : stencil) {
+                Pixel expected = line.next();
+                Pixel result   = {start.x + sign * offset.x,
+                                  start.y + sign * offset.y};
+                ASSERT_EQ(result, expected) << "angle " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include <PyramidGridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+template <uint Factor>
+static void expectSameSquare(float tolerance) {
+    auto gf      = std::make_unique<GridFinder<410, 308>>(mask);
+    auto pyramid = std::make_unique<PyramidGridFinder<410, 308, Factor>>(mask);
+    Square full  = gf->findSquare();
+    Square sq    = pyramid->findSquare();
+    EXPECT_FALSE(sq.truncated);
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(full.points[i].has_value());
+        ASSERT_TRUE(sq.points[i].has_value());
+        EXPECT_NEAR(sq.points[i]->x, full.points[i]->x, tolerance);
+        EXPECT_NEAR(sq.points[i]->y, full.points[i]->y, tolerance);
+    }
+    // The step count includes the refinement at full resolution
+    EXPECT_GT(pyramid->getStepCount(), pyramid->getCoarse().getStepCount());
+    EXPECT_LT(pyramid->getStepCount(), gf->getStepCount());
+}
+
+TEST(PyramidGridFinder, findSquare2) { expectSameSquare<2>(3); }
+
+TEST(PyramidGridFinder, findSquare4) { expectSameSquare<4>(3); }
+
+TEST(PyramidGridFinder, downsampleKeepsThinLines) {
+    using PGF  = PyramidGridFinder<16, 12, 4>;
+    auto image = std::make_unique<PGF::Img_t>();
+    *image     = {};
+    // One pixel wide vertical line
+    for (uint y = 0; y < 12; ++y)
+        (*image)[y][5] = 0xFF;
+    // Single pixel in the incomplete last row
+    (*image)[11][15] = 0xFF;
+    PGF::CoarseImg_t coarseImg;
+    PGF::downsample(*image, coarseImg);
+    for (uint y = 0; y < 3; ++y) {
+        for (uint x = 0; x < 4; ++x) {
+            bool white = x == 1 || (x == 3 && y == 2);
+            EXPECT_EQ(coarseImg[y][x], white ? 0xFF : 0x00) << x << ", " << y;
+        }
+    }
+}
+
+TEST(PyramidGridFinder, budgetIncludesRefinement) {
+    using PGF = PyramidGridFinder<410, 308, 2>;
+    // Fresh finders for every search, the Hough cache of the full resolution
+    // finder is kept as long as the mask doesn't change
+    auto pyramid = std::make_unique<PGF>(mask);
+    pyramid->findSquare();
+    const size_t coarseSteps = pyramid->getCoarse().getStepCount();
+    const size_t totalSteps  = pyramid->getStepCount();
+    // Enough for the coarse search, but not for all of the refinement
+    pyramid   = std::make_unique<PGF>(mask);
+    Square sq = pyramid->findSquare(SearchBudget::steps(coarseSteps + 1));
+    EXPECT_TRUE(sq.truncated);
+    EXPECT_LT(pyramid->getStepCount(), totalSteps);
+    // Enough for everything
+    pyramid = std::make_unique<PGF>(mask);
+    sq      = pyramid->findSquare(SearchBudget::steps(totalSteps));
+    EXPECT_FALSE(sq.truncated);
+    EXPECT_EQ(pyramid->getStepCount(), totalSteps);
+}
+
+TEST(PyramidGridFinder, setMask) {
+    auto empty = std::make_unique<TMatrix<uint8_t, 308, 410>>();
+    for (auto &row : *empty)
+        row.fill(0);
+    auto pyramid = std::make_unique<PyramidGridFinder<410, 308, 2>>(*empty);
+    EXPECT_FALSE(pyramid->findSquare().points[0].has_value());
+    pyramid->setMask(mask);
+    auto fresh = std::make_unique<PyramidGridFinder<410, 308, 2>>(mask);
+    Square expected = fresh->findSquare();
+    Square sq       = pyramid->findSquare();
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(sq.points[i], expected.points[i]);
+    EXPECT_EQ(pyramid->getStepCount(), fresh->getStepCount());
+}
@@ -0,0 +1,67 @@
+#include <GridFinder.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+using GF = GridFinder<410, 308>;
+
+static void expectNear(const Square &a, const Square &b, float tolerance) {
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(a.points[i].has_value());
+        ASSERT_TRUE(b.points[i].has_value());
+        EXPECT_NEAR(a.points[i]->x, b.points[i]->x, tolerance);
+        EXPECT_NEAR(a.points[i]->y, b.points[i]->y, tolerance);
+    }
+}
+
+TEST(RegionOfInterest, clipped) {
+    auto gf = std::make_unique<GF>();
+    gf->setRegionOfInterest({400, 300, 100, 100});
+    EXPECT_EQ(gf->getRegionOfInterest(), Rect({400, 300, 10, 8}));
+    gf->resetRegionOfInterest();
+    EXPECT_EQ(gf->getRegionOfInterest(), Rect({0, 0, 410, 308}));
+}
+
+TEST(RegionOfInterest, findSquare) {
+    auto gf     = std::make_unique<GF>(mask);
+    Square full = gf->findSquare();
+
+    // Region around the square that was found in the full frame
+    Rect roi = {60, 20, 250, 240};
+    gf->setRegionOfInterest(roi);
+    Square sq = gf->findSquare();
+    expectNear(sq, full, 3);
+
+    // Pixels outside of the region of interest should never be accessed
+    auto noisy = std::make_unique<GF>(mask);
+    for (uint y = 0; y < 308; ++y)
+        for (uint x = 0; x < 410; ++x)
+            if (!roi.contains({x, y}))
+                noisy->set({x, y}, 0xFF);
+    noisy->setRegionOfInterest(roi);
+    Square noisySq = noisy->findSquare();
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(noisySq.points[i], sq.points[i]);
+}
+
+TEST(RegionOfInterest, bresenham) {
+    BresenhamLine line = {{5, 5}, angle_t(0.0), Rect{3, 3, 4, 4}};
+    uint length        = 0;
+    while (line.hasNext()) {
+        Pixel px = line.next();
+        EXPECT_TRUE(Rect({3, 3, 4, 4}).contains(px));
+        ++length;
+    }
+    EXPECT_EQ(length, 2);
+}
+
+TEST(RegionOfInterest, nextLineOutsideRegion) {
+    auto gf = std::make_unique<GF>(mask);
+    gf->setRegionOfInterest({100, 100, 50, 50});
+    // The search path starts outside of the region of interest: no line, and
+    // no out_of_range exception either
+    LineResult line = {{10, 10}, 5, angle_t(0u)};
+    EXPECT_FALSE(gf->findNextLine(line, true).has_value());
+    EXPECT_FALSE(gf->findNextLine(line, false).has_value());
+}
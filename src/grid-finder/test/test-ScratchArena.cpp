@@ -0,0 +1,58 @@
+#include <GridFinder.hpp>
+#include <ScratchArena.hpp>
+#include "AllocationCounter.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+TEST(ScratchArena, allocate) {
+    ScratchArena<64> arena;
+    Span<uint8_t> a  = arena.allocate<uint8_t>(3);
+    Span<uint32_t> b = arena.allocate<uint32_t>(4);
+    EXPECT_EQ(a.size(), 3);
+    EXPECT_EQ(b.size(), 4);
+    // The second allocation should be aligned
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b.data()) % alignof(uint32_t), 0);
+    EXPECT_EQ(arena.getUsed(), 4 + 4 * sizeof(uint32_t));
+    EXPECT_EQ(arena.getAllocationCount(), 2);
+}
+
+TEST(ScratchArena, overflow) {
+    ScratchArena<16> arena;
+    arena.allocate<uint8_t>(16);
+    EXPECT_THROW(arena.allocate<uint8_t>(1), std::bad_alloc);
+}
+
+TEST(ScratchArena, reset) {
+    ScratchArena<16> arena;
+    arena.allocate<uint8_t>(16);
+    arena.reset();
+    EXPECT_EQ(arena.getUsed(), 0);
+    EXPECT_EQ(arena.getHighWaterMark(), 16);
+    EXPECT_NO_THROW(arena.allocate<uint8_t>(16));
+}
+
+TEST(ScratchArena, scope) {
+    ScratchArena<16> arena;
+    arena.allocate<uint8_t>(4);
+    {
+        ScratchArena<16>::Scope scope = arena;
+        arena.allocate<uint8_t>(12);
+        EXPECT_EQ(arena.getUsed(), 16);
+    }
+    EXPECT_EQ(arena.getUsed(), 4);
+}
+
+TEST(ScratchArena, findSquareDoesNotAllocate) {
+    using GF = GridFinder<410, 308>;
+    auto gf  = std::make_unique<GF>(mask);
+    gf->findSquare();  // warm-up (e.g. lazy initialization of streams)
+
+    AllocationCounter::Scope allocations;
+    Square sq = gf->findSquare();
+    EXPECT_EQ(allocations.getCount(), 0);
+    EXPECT_TRUE(sq.points[3].has_value());
+    EXPECT_GT(gf->getScratch().getAllocationCount(), 0);
+    EXPECT_LE(gf->getScratch().getHighWaterMark(), GF::SCRATCH_SIZE);
+}
@@ -0,0 +1,97 @@
+#include <GridFinder.hpp>
+#include <SearchBudget.hpp>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+
+extern TMatrix<uint8_t, 308, 410> mask;
+
+TEST(SearchBudget, steps) {
+    SearchBudget budget = SearchBudget::steps(10);
+    budget.charge(10);
+    EXPECT_FALSE(budget.exhausted());
+    budget.charge(1);
+    EXPECT_TRUE(budget.exhausted());
+    EXPECT_TRUE(budget.wasExhausted());
+}
+
+TEST(SearchBudget, deadline) {
+    SearchBudget budget = SearchBudget::until(SearchBudget::Clock::now());
+    EXPECT_TRUE(budget.exhausted());
+}
+
+TEST(SearchBudget, unlimited) {
+    SearchBudget budget;
+    budget.charge(1'000'000'000);
+    EXPECT_FALSE(budget.exhausted());
+}
+
+TEST(SearchBudget, findSquareUnlimited) {
+    auto gf   = std::make_unique<GridFinder<410, 308>>(mask);
+    Square sq = gf->findSquare();
+    EXPECT_FALSE(sq.truncated);
+    EXPECT_TRUE(sq.points[3].has_value());
+    EXPECT_GT(gf->getStepCount(), 0);
+}
+
+TEST(SearchBudget, findSquareTruncated) {
+    auto gf          = std::make_unique<GridFinder<410, 308>>(mask);
+    size_t fullSteps = (gf->findSquare(), gf->getStepCount());
+
+    Square sq = gf->findSquare(SearchBudget::steps(fullSteps / 4));
+    EXPECT_TRUE(sq.truncated);
+    EXPECT_FALSE(sq.points[3].has_value());
+    // The search stops soon after the budget runs out (the primitive that's
+    // running at that moment, e.g. a ray or a width probe, is finished first)
+    EXPECT_LE(gf->getStepCount(), fullSteps / 4 + 2 * (410 + 308));
+
+    // Functions called after a truncated search are not limited
+    EXPECT_FALSE(gf->findSquare().truncated);
+}
+
+TEST(SearchBudget, findSquareLargeBudget) {
+    auto gf          = std::make_unique<GridFinder<410, 308>>(mask);
+    Square full      = gf->findSquare();
+    size_t fullSteps = gf->getStepCount();
+    Square sq        = gf->findSquare(SearchBudget::steps(fullSteps));
+    EXPECT_FALSE(sq.truncated);
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(sq.points[i], full.points[i]);
+}
+
+TEST(SearchBudget, truncatedCornersAreAccurate) {
+    auto gf          = std::make_unique<GridFinder<410, 308>>(mask);
+    Square full      = gf->findSquare();
+    size_t fullSteps = gf->getStepCount();
+    // Lines whose angle histogram was cut short by the budget are dropped, so
+    // a truncated square may have fewer corners, but never wrong ones
+    for (size_t steps = 0; steps <= fullSteps; steps += 13) {
+        gf->setMask(mask);  // clears the Hough cache
+        Square sq = gf->findSquare(SearchBudget::steps(steps));
+        for (size_t i = 0; i < 4; ++i) {
+            if (!sq.points[i].has_value())
+                continue;
+            EXPECT_NEAR(sq.points[i]->x, full.points[i]->x, 0.5) << steps;
+            EXPECT_NEAR(sq.points[i]->y, full.points[i]->y, 0.5) << steps;
+        }
+    }
+}
+
+TEST(SearchBudget, cancelWhen) {
+    std::atomic<bool> cancel{false};
+    SearchBudget budget;
+    budget.cancelWhen(cancel);
+    EXPECT_FALSE(budget.exhausted());
+    cancel = true;
+    EXPECT_TRUE(budget.exhausted());
+    EXPECT_TRUE(budget.wasCancelled());
+}
+
+TEST(SearchBudget, findSquareCancelled) {
+    auto gf = std::make_unique<GridFinder<410, 308>>(mask);
+    std::atomic<bool> cancel{true};
+    Square sq = gf->findSquare(SearchBudget().cancelWhen(cancel));
+    EXPECT_EQ(sq.status, SearchStatus::Cancelled);
+    EXPECT_FALSE(sq.truncated);
+    EXPECT_FALSE(sq.points[3].has_value());
+}
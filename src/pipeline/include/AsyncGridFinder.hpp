@@ -0,0 +1,171 @@
+#pragma once
+
+#include <GridFinder.hpp>
+#include <SearchBudget.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief   Runs GridFinder::findSquare on a worker thread of its own, so the
+ *          caller can keep working while the search runs.
+ *
+ * Every request returns a future, and can optionally call a callback (on the
+ * worker thread) when it's done. Only the newest frame matters:
+ *  - A request that is still waiting when a newer one is submitted is not
+ *    searched at all, it's completed right away with SearchStatus::Cancelled.
+ *  - Optionally, the search that's in progress is cancelled as well (through
+ *    SearchBudget::cancelWhen), it's completed with SearchStatus::Cancelled
+ *    and the lines it found so far.
+ * So the latency of a new frame is at most the time it takes the running
+ * search to notice the cancellation, instead of a full search of a stale
+ * frame.
+ *
+ * @tparam  GridFinder_t
+ *          The GridFinder type (resolution, parameters and storage).
+ */
+template <class GridFinder_t>
+class AsyncGridFinder {
+  public:
+    using Img_t    = typename GridFinder_t::Img_t;
+    using Callback = std::function<void(const Square &)>;
+
+    /// Start the worker thread.
+    AsyncGridFinder()
+        : gf(std::make_unique<GridFinder_t>()),
+          next(std::make_unique<Img_t>()), current(std::make_unique<Img_t>()),
+          worker(&AsyncGridFinder::run, this) {}
+
+    AsyncGridFinder(const AsyncGridFinder &) = delete;
+    AsyncGridFinder &operator=(const AsyncGridFinder &) = delete;
+
+    /// Cancel all requests and stop the worker thread.
+    ~AsyncGridFinder() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cancelFlag = true;
+        wakeUp.notify_one();
+        worker.join();
+    }
+
+    /**
+     * @brief   Search the given mask on the worker thread.
+     *
+     * @param   mask
+     *          The mask to search, it's copied.
+     * @param   callback
+     *          Called with the result, on the worker thread (or on the calling
+     *          thread if the request is replaced by a newer one).
+     * @param   cancelRunning
+     *          Also cancel the search that's in progress, if any.
+     * @return  A future that becomes ready when the result is available.
+     */
+    std::shared_future<Square> submit(const Img_t &mask, Callback callback = {},
+                                      bool cancelRunning = true) {
+        Request replaced;
+        bool hasReplaced;
+        std::shared_future<Square> future;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            *next       = mask;
+            hasReplaced = waiting;
+            if (hasReplaced)
+                replaced = std::move(request);
+            request = Request{std::promise<Square>(), std::move(callback)};
+            future  = request.promise.get_future().share();
+            waiting = true;
+            if (busy && cancelRunning)
+                cancelFlag = true;
+        }
+        wakeUp.notify_one();
+        if (hasReplaced)
+            complete(replaced, cancelled());
+        return future;
+    }
+
+    /// Cancel the search in progress (if any). Requests that are submitted
+    /// later are not affected.
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (busy)
+            cancelFlag = true;
+    }
+
+    /// Get the GridFinder, e.g. to change its parameters or to drain its
+    /// diagnostics. Only safe while no request is in progress.
+    GridFinder_t &getGridFinder() { return *gf; }
+
+  private:
+    struct Request {
+        std::promise<Square> promise;
+        Callback callback;
+    };
+
+    static Square cancelled() {
+        Square sq;
+        sq.status = SearchStatus::Cancelled;
+        return sq;
+    }
+
+    static void complete(Request &request, const Square &sq) {
+        if (request.callback)
+            request.callback(sq);
+        request.promise.set_value(sq);
+    }
+
+    /// The main loop of the worker thread.
+    void run() {
+        while (true) {
+            Request active;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this] { return waiting || stopping; });
+                if (stopping) {
+                    if (waiting) {
+                        waiting = false;
+                        lock.unlock();
+                        complete(request, cancelled());
+                    }
+                    return;
+                }
+                active = std::move(request);
+                std::swap(next, current);
+                waiting    = false;
+                busy       = true;
+                cancelFlag = false;
+            }
+            gf->setMask(*current);
+            Square sq = gf->findSquare(SearchBudget().cancelWhen(cancelFlag));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy = false;
+            }
+            complete(active, sq);
+        }
+    }
+
+    /// Only used by the worker thread.
+    std::unique_ptr<GridFinder_t> gf;
+    /// Set to cancel the search that's in progress.
+    std::atomic<bool> cancelFlag{false};
+
+    /// Protects all members below.
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    /// The mask of the waiting request, swapped with #current when it's
+    /// started, so the masks are never reallocated.
+    std::unique_ptr<Img_t> next, current;
+    Request request;        ///< The waiting request.
+    bool waiting  = false;  ///< Whether #request is waiting.
+    bool busy     = false;  ///< Whether a search is in progress.
+    bool stopping = false;  ///< Set by the destructor.
+
+    /// Started last, when all other members are initialized.
+    std::thread worker;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <GridFinder.hpp>
+#include <RedMask.hpp>
+#include <SPSCQueue.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>  // memcpy
+#include <memory>
+#include <thread>
+#include <uint.hpp>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief   Runs the masking and the search of a video on two threads, each on
+ *          its own core, so the frame rate is set by the slowest stage instead
+ *          of the sum of all stages.
+ *
+ * The frames travel through the pipeline as pointers to preallocated buffers,
+ * over lock-free single-producer, single-consumer queues:
+ *
+ * ```
+ *   push ──▶ masking thread ──▶ finder thread ──▶ pop
+ *    ▲    (RGB → mask, isRed)   (findSquare)       │
+ *    └──────────────── free frames ◀───────────────┘
+ * ```
+ *
+ * #push and #pop may be called from the same thread (e.g. the Python thread
+ * that reads and draws the video), or #push from one thread and #pop from
+ * another one. Nothing is allocated or locked after construction.
+ *
+ * @tparam  W
+ *          The width of the frames in pixels.
+ * @tparam  H
+ *          The height of the frames in pixels.
+ * @tparam  Depth
+ *          The number of frames in flight, must be a power of two. When all
+ *          of them are in use, #push drops the frame.
+ */
+template <size_t W, size_t H, size_t Depth = 4>
+class FramePipeline {
+  public:
+    using GridFinder_t = GridFinder<W, H>;
+    using Img_t        = typename GridFinder_t::Img_t;
+    /// An RGB frame, three bytes per pixel, row by row.
+    using RGB_t = std::array<uint8_t, W * H * 3>;
+
+    /// A frame buffer, reused for all frames.
+    struct Frame {
+        size_t sequence;  ///< The number of the frame, counted by #push.
+        RGB_t rgb;        ///< The input image.
+        Img_t mask;       ///< The output of the masking stage.
+        Square square;    ///< The output of the finder stage.
+    };
+
+    /// The work done by a stage so far.
+    struct StageStats {
+        size_t frames;  ///< The number of frames processed.
+        double busy;    ///< The time spent processing them, in seconds.
+    };
+
+    /**
+     * @brief   Allocate the frames. The threads are not started yet.
+     *
+     * @param   maskCore
+     *          The core to pin the masking thread to, or -1 to let the
+     *          operating system decide.
+     * @param   finderCore
+     *          The core to pin the finder thread to, or -1.
+     */
+    explicit FramePipeline(int maskCore = -1, int finderCore = -1)
+        : frames(std::make_unique<std::array<Frame, Depth>>()),
+          gf(std::make_unique<GridFinder_t>()), maskCore(maskCore),
+          finderCore(finderCore) {
+        for (Frame &frame : *frames)
+            free.push(&frame);
+    }
+
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    ~FramePipeline() { stop(); }
+
+    /// Start the masking and finder threads.
+    void start() {
+        if (running.exchange(true))
+            return;
+        maskThread   = std::thread(&FramePipeline::maskStage, this);
+        finderThread = std::thread(&FramePipeline::finderStage, this);
+        pin(maskThread, maskCore);
+        pin(finderThread, finderCore);
+    }
+
+    /// Stop the threads. Frames that are in flight stay in the pipeline, and
+    /// continue when the pipeline is started again.
+    void stop() {
+        if (!running.exchange(false))
+            return;
+        maskThread.join();
+        finderThread.join();
+    }
+
+    bool isRunning() const { return running.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief   Copy an RGB image into a free frame, and send it to the masking
+     *          stage.
+     *
+     * @return  False if all frames are in use (the consumer doesn't keep up),
+     *          the image is dropped.
+     */
+    bool push(const uint8_t *rgb) {
+        Frame *frame;
+        if (!free.pop(frame))
+            return false;
+        std::memcpy(frame->rgb.data(), rgb, frame->rgb.size());
+        frame->sequence = pushed.load(std::memory_order_relaxed);
+        input.push(frame);  // never full, there are only Depth frames
+        pushed.store(frame->sequence + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief   Get the oldest frame that has been processed by both stages.
+     *          The frame must be returned with #release when the caller is
+     *          done with it.
+     *
+     * @return  The frame, or a null pointer if no frame is ready yet.
+     */
+    Frame *pop() {
+        Frame *frame = nullptr;
+        if (output.pop(frame))
+            popped.fetch_add(1, std::memory_order_relaxed);
+        return frame;
+    }
+
+    /**
+     * @brief   Same as #pop, but wait for the next frame if there are frames
+     *          in flight and the pipeline is running.
+     *
+     * @return  The frame, or a null pointer if there's nothing to wait for.
+     */
+    Frame *popWait() {
+        while (true) {
+            if (Frame *frame = pop())
+                return frame;
+            if (getInFlight() == 0 || !isRunning())
+                return nullptr;
+            std::this_thread::yield();
+        }
+    }
+
+    /// Get the number of frames that were pushed, but not popped yet.
+    size_t getInFlight() const {
+        return pushed.load(std::memory_order_acquire) -
+               popped.load(std::memory_order_relaxed);
+    }
+
+    /// Return a frame that was obtained from #pop, so it can be reused.
+    void release(Frame *frame) { free.push(frame); }
+
+    /// Get the number of frames processed by the masking stage, and the time
+    /// it spent on them.
+    StageStats getMaskStats() const { return maskStats.get(); }
+    /// Same as #getMaskStats, but for the finder stage.
+    StageStats getFinderStats() const { return finderStats.get(); }
+
+    /// Compute the mask of an RGB image, using the same thresholds as the
+    /// corpus tools (see isRed).
+    static void redMask(const RGB_t &rgb, Img_t &mask) {
+        const uint8_t *px = rgb.data();
+        for (uint y = 0; y < H; ++y)
+            for (uint x = 0; x < W; ++x, px += 3)
+                mask[y][x] = isRed(px[0], px[1], px[2]) ? 0xFF : 0x00;
+    }
+
+    /**
+     * @brief   Pin a thread to the given core. Only supported on Linux.
+     * @return  False if the thread could not be pinned (or @p core < 0).
+     */
+    static bool pin(std::thread &thread, int core) {
+#ifdef __linux__
+        if (core < 0)
+            return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(thread.native_handle(), sizeof(set),
+                                      &set) == 0;
+#else
+        (void) thread, (void) core;
+        return false;
+#endif
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using Queue = SPSCQueue<Frame *, Depth>;
+
+    /// The counters of a stage, written by its thread only.
+    struct AtomicStageStats {
+        std::atomic<size_t> frames{0};
+        std::atomic<uint64_t> busy{0};  ///< In nanoseconds.
+
+        void add(Clock::duration d) {
+            using std::chrono::duration_cast;
+            using std::chrono::nanoseconds;
+            busy.fetch_add(duration_cast<nanoseconds>(d).count(),
+                           std::memory_order_relaxed);
+            frames.fetch_add(1, std::memory_order_relaxed);
+        }
+        StageStats get() const {
+            return {frames.load(std::memory_order_relaxed),
+                    busy.load(std::memory_order_relaxed) * 1e-9};
+        }
+    };
+
+    /// The number of times a stage polls its empty input queue before it
+    /// starts sleeping between polls.
+    constexpr static uint SPIN_COUNT = 256;
+    /// How long a stage sleeps between polls after spinning.
+    constexpr static auto IDLE_SLEEP = std::chrono::microseconds(20);
+
+    /// Take frames from @p in, process them, and pass them on to @p out,
+    /// until the pipeline is stopped. While there are no frames, the stage
+    /// spins for a while (its own core has nothing else to do), and then
+    /// sleeps, so it doesn't steal time from the other stages if they share
+    /// a core.
+    template <class F>
+    void runStage(Queue &in, Queue &out, AtomicStageStats &stats, F process) {
+        uint idle = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            Frame *frame;
+            if (!in.pop(frame)) {
+                if (++idle < SPIN_COUNT)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(IDLE_SLEEP);
+                continue;
+            }
+            idle       = 0;
+            auto start = Clock::now();
+            process(*frame);
+            stats.add(Clock::now() - start);
+            out.push(frame);
+        }
+    }
+
+    void maskStage() {
+        runStage(input, masked, maskStats,
+                 [](Frame &frame) { redMask(frame.rgb, frame.mask); });
+    }
+
+    void finderStage() {
+        runStage(masked, output, finderStats, [this](Frame &frame) {
+            gf->setMask(frame.mask);
+            frame.square = gf->findSquare();
+        });
+    }
+
+    std::unique_ptr<std::array<Frame, Depth>> frames;
+    /// Only used by the finder thread.
+    std::unique_ptr<GridFinder_t> gf;
+    /// Every frame is in exactly one of the queues, or owned by one of the
+    /// threads or the caller of #pop.
+    Queue free, input, masked, output;
+    AtomicStageStats maskStats, finderStats;
+    std::thread maskThread, finderThread;
+    std::atomic<bool> running{false};
+    int maskCore, finderCore;
+    /// The number of frames pushed (by the caller of #push) and popped (by
+    /// the caller of #pop).
+    std::atomic<size_t> pushed{0}, popped{0};
+};
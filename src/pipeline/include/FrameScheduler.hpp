@@ -0,0 +1,296 @@
+#pragma once
+
+#include <GridFinder.hpp>
+#include <SearchBudget.hpp>
+#include <ThreadPool.hpp>
+#include <algorithm>  // min, max
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <uint.hpp>
+#include <vector>
+
+/**
+ * @brief   Runs GridFinder on the frames of several cameras (streams) on one
+ *          shared pool of worker threads, earliest deadline first.
+ *
+ * Every stream has a relative deadline: a frame is useless if its result isn't
+ * available within that time after it was captured. The scheduler never
+ * queues old frames:
+ *  - Every stream has a single slot for a waiting frame. Submitting a new
+ *    frame while the previous one is still waiting replaces it (the old frame
+ *    is counted as StreamStats::replaced).
+ *  - When a worker becomes available, it takes the waiting frame with the
+ *    earliest absolute deadline. Frames whose deadline has already passed are
+ *    dropped (StreamStats::expired).
+ *  - The search gets a SearchBudget that ends at the deadline, so a frame that
+ *    is started in time is also finished (approximately) in time, possibly
+ *    with a Square::truncated result.
+ *
+ * Every stream has its own GridFinder, so the frames of one stream are
+ * processed one at a time, in order, and their results are delivered in
+ * order, but different streams run in parallel.
+ * In tracking mode, the region of interest of a stream follows the last square
+ * that was found, and falls back to the full frame when nothing is found.
+ *
+ * Results are passed to a callback, on the worker thread that produced them.
+ *
+ * @tparam  GridFinder_t
+ *          The GridFinder type (resolution, parameters and storage) used for
+ *          all streams.
+ */
+template <class GridFinder_t>
+class FrameScheduler {
+  public:
+    using Img_t = typename GridFinder_t::Img_t;
+    using Clock = SearchBudget::Clock;
+
+    /// The settings of a single stream.
+    struct StreamConfig {
+        /// The time after capture by which the result must be available.
+        Clock::duration deadline = std::chrono::milliseconds(10);
+        /// Only search around the square found in the previous frame.
+        bool tracking = false;
+    };
+
+    /// The result of a single frame.
+    struct Result {
+        uint stream;                 ///< The index of the stream.
+        size_t sequence;             ///< The number of the frame in its stream.
+        Square square;               ///< The result of GridFinder::findSquare.
+        Clock::time_point captured;  ///< When the frame was captured.
+        Clock::time_point started;   ///< When the search started.
+        Clock::time_point finished;  ///< When the search finished.
+        /// Whether the search finished after the deadline of the frame.
+        bool late;
+    };
+
+    /// Counters of a single stream.
+    struct StreamStats {
+        size_t submitted = 0;  ///< Frames passed to #submit.
+        size_t processed = 0;  ///< Frames that were searched.
+        size_t replaced  = 0;  ///< Frames dropped because a newer one arrived.
+        size_t expired   = 0;  ///< Frames dropped because they were too old.
+        size_t late      = 0;  ///< Processed frames that missed the deadline.
+        size_t truncated = 0;  ///< Processed frames with a truncated search.
+        /// Sum and maximum of the time from capture to the result.
+        Clock::duration totalLatency = {}, maxLatency = {};
+
+        /// The mean time from capture to the result of the processed frames.
+        Clock::duration meanLatency() const {
+            if (processed == 0)
+                return {};
+            return totalLatency / processed;
+        }
+    };
+
+    using Callback = std::function<void(const Result &)>;
+
+    /**
+     * @brief   Create a scheduler for the given streams.
+     *
+     * @param   streams
+     *          The settings of each stream, streams are identified by their
+     *          index in this vector.
+     * @param   callback
+     *          Called with the result of every frame that is processed, on the
+     *          worker thread. It must be thread-safe.
+     * @param   numThreads
+     *          The number of worker threads shared by all streams.
+     */
+    FrameScheduler(const std::vector<StreamConfig> &streams, Callback callback,
+                   uint numThreads = ThreadPool::defaultNumThreads())
+        : callback(std::move(callback)) {
+        for (uint i = 0; i < streams.size(); ++i)
+            this->streams.emplace_back(std::make_unique<Stream>(i, streams[i]));
+        pool = std::make_unique<ThreadPool>(numThreads);
+    }
+
+    /// Finish the frames that are still waiting and stop the workers.
+    ~FrameScheduler() { pool.reset(); }
+
+    /**
+     * @brief   Submit a frame of the given stream.
+     *
+     * The mask is copied (outside of the lock, so the workers are not held
+     * up), and it can be reused by the caller right away. Every stream must
+     * have a single producer thread, different streams can be submitted to
+     * from different threads.
+     *
+     * @param   stream
+     *          The index of the stream.
+     * @param   mask
+     *          The mask of the frame.
+     * @param   captured
+     *          When the frame was captured, the deadline is relative to this.
+     * @return  False if the previous frame of the stream was still waiting,
+     *          and was replaced.
+     */
+    bool submit(uint stream, const Img_t &mask,
+                Clock::time_point captured = Clock::now()) {
+        Stream &s = *streams.at(stream);
+        if (!s.incoming)
+            s.incoming = std::make_unique<Img_t>();
+        *s.incoming = mask;
+        bool replaced;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            replaced = s.waiting;
+            std::swap(s.incoming, s.next);
+            s.captured = captured;
+            s.sequence = s.stats.submitted++;
+            s.waiting  = true;
+            s.stats.replaced += replaced;
+        }
+        // Frames that were replaced already have a task that will pick up
+        // the new frame
+        if (!replaced)
+            pool->submit([this] { runWaiting(); });
+        return !replaced;
+    }
+
+    /// Block until all submitted frames have been processed or dropped.
+    void wait() { pool->wait(); }
+
+    /// Get the counters of the given stream.
+    StreamStats getStats(uint stream) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return streams.at(stream)->stats;
+    }
+
+    /// Get the number of streams.
+    uint getNumStreams() const { return streams.size(); }
+
+    /// Get the GridFinder of the given stream, e.g. to change its parameters
+    /// or to drain its diagnostics. Only safe while the stream is idle.
+    GridFinder_t &getGridFinder(uint stream) { return *streams.at(stream)->gf; }
+
+  private:
+    struct Stream {
+        Stream(uint index, StreamConfig config)
+            : index(index), config(config),
+              gf(std::make_unique<GridFinder_t>()) {}
+
+        uint index;
+        StreamConfig config;
+        /// Only used by the worker that's currently processing the stream.
+        std::unique_ptr<GridFinder_t> gf;
+        /// Triple buffering: the frame that's being copied by #submit, the
+        /// waiting frame, and the frame that's being processed. Swapped under
+        /// the lock, so the masks are copied only once and never reallocated.
+        std::unique_ptr<Img_t> incoming, next, current;
+        Clock::time_point captured;
+        size_t sequence = 0;
+        bool waiting    = false;  ///< Whether #next contains a frame.
+        bool busy       = false;  ///< Whether a worker is processing it.
+        StreamStats stats;
+
+        Clock::time_point deadline() const {
+            return captured + config.deadline;
+        }
+    };
+
+    /// Process waiting frames until there are none left that can be started.
+    void runWaiting() {
+        while (runNext())
+            continue;
+    }
+
+    /**
+     * @brief   Take the waiting frame with the earliest deadline of a stream
+     *          that's not busy, drop it if it's too old, and process it
+     *          otherwise.
+     * @return  False if there was no such frame.
+     */
+    bool runNext() {
+        Stream *s = nullptr;
+        Result result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto now = Clock::now();
+            for (auto &candidate : streams) {
+                if (!candidate->waiting || candidate->busy)
+                    continue;
+                if (candidate->deadline() <= now) {
+                    candidate->waiting = false;
+                    ++candidate->stats.expired;
+                } else if (!s || candidate->deadline() < s->deadline()) {
+                    s = candidate.get();
+                }
+            }
+            if (!s)
+                return false;
+            std::swap(s->next, s->current);
+            s->waiting      = false;
+            s->busy         = true;
+            result.stream   = s->index;
+            result.sequence = s->sequence;
+            result.captured = s->captured;
+        }
+
+        // The stream is busy, so only this thread accesses its GridFinder
+        GridFinder_t &gf    = *s->gf;
+        const auto deadline = result.captured + s->config.deadline;
+        gf.setMask(*s->current);
+        result.started  = Clock::now();
+        result.square   = gf.findSquare(SearchBudget::until(deadline));
+        result.finished = Clock::now();
+        result.late     = result.finished > deadline;
+        if (s->config.tracking)
+            track(gf, result.square);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            StreamStats &stats = s->stats;
+            ++stats.processed;
+            stats.late += result.late;
+            stats.truncated += result.square.truncated;
+            const auto latency = result.finished - result.captured;
+            stats.totalLatency += latency;
+            stats.maxLatency = std::max(stats.maxLatency, latency);
+        }
+        // The stream stays busy until its result is delivered, otherwise the
+        // next frame could be processed by another worker, and its result
+        // could arrive first
+        auto idle = [this, s] {
+            std::lock_guard<std::mutex> lock(mutex);
+            s->busy = false;
+        };
+        try {
+            callback(result);
+        } catch (...) {
+            idle();
+            throw;
+        }
+        idle();
+        return true;
+    }
+
+    /// Search the next frame around the square that was found in this one,
+    /// with a margin of the size of the square on all sides (the neighboring
+    /// squares of the grid have about the same size).
+    static void track(GridFinder_t &gf, const Square &sq) {
+        float minX = 1e9, minY = 1e9, maxX = -1e9, maxY = -1e9;
+        for (const auto &p : sq.points) {
+            if (sq.status != SearchStatus::Ok || !p.has_value()) {
+                gf.resetRegionOfInterest();
+                return;
+            }
+            minX = std::min(minX, p->x), maxX = std::max(maxX, p->x);
+            minY = std::min(minY, p->y), maxY = std::max(maxY, p->y);
+        }
+        const float margin = std::max(maxX - minX, maxY - minY);
+        const float x      = std::max(minX - margin, 0.f);
+        const float y      = std::max(minY - margin, 0.f);
+        gf.setRegionOfInterest({uint(x), uint(y), uint(maxX + margin - x),
+                                uint(maxY + margin - y)});
+    }
+
+    std::vector<std::unique_ptr<Stream>> streams;
+    Callback callback;
+    /// Protects the frames, flags and counters of all streams.
+    mutable std::mutex mutex;
+    /// Destroyed first, so the workers finish before the streams are gone.
+    std::unique_ptr<ThreadPool> pool;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief   A bounded lock-free single-producer, single-consumer queue.
+ *
+ * One thread pushes, one (other) thread pops, neither of them ever blocks or
+ * allocates. The head and tail indices are on separate cache lines, and each
+ * side keeps a cached copy of the other side's index, so the cache line of the
+ * other side is only read when the queue looks full (producer) or empty
+ * (consumer).
+ *
+ * @tparam  T
+ *          The type of the elements, usually a pointer to a preallocated
+ *          buffer.
+ * @tparam  Capacity
+ *          The maximum number of elements in the queue, must be a power of
+ *          two.
+ */
+template <class T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+  public:
+    /**
+     * @brief   Add an element to the back of the queue (producer only).
+     * @return  False if the queue was full, the element is not added.
+     */
+    bool push(const T &value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail == Capacity) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail == Capacity)
+                return false;
+        }
+        buffer[h % Capacity] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief   Remove the element at the front of the queue (consumer only).
+     * @return  False if the queue was empty, @p value is not changed.
+     */
+    bool pop(T &value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                return false;
+        }
+        value = buffer[t % Capacity];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Get the number of elements in the queue (approximate if the other
+    /// thread is pushing or popping at the same time).
+    size_t size() const {
+        return head.load(std::memory_order_acquire) -
+               tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+  private:
+    /// Written by the producer only, together with its copy of #tail.
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    /// Written by the consumer only, together with its copy of #head.
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    alignas(64) std::array<T, Capacity> buffer{};
+};
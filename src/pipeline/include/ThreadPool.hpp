@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>  // max
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <uint.hpp>
+#include <vector>
+
+/**
+ * @brief   A work-stealing thread pool.
+ *
+ * Every worker has its own queue of tasks. Newly submitted tasks are
+ * distributed over the queues in a round-robin fashion. A worker takes tasks
+ * from the back of its own queue, and when its queue is empty, it steals tasks
+ * from the front of the other workers' queues. This keeps all workers busy,
+ * even if some tasks (frames) take much longer than others.
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    /// Start the given number of worker threads.
+    explicit ThreadPool(uint numThreads = defaultNumThreads()) {
+        if (numThreads == 0)
+            numThreads = 1;
+        for (uint i = 0; i < numThreads; ++i)
+            queues.emplace_back(std::make_unique<WorkQueue>());
+        for (uint i = 0; i < numThreads; ++i)
+            threads.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// Finish all tasks and stop the worker threads.
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (std::thread &t : threads)
+            t.join();
+    }
+
+    /// Add a task to the queue of one of the workers.
+    void submit(Task task) {
+        uint index = nextQueue++ % queues.size();
+        // Count the task before it's visible to the workers, otherwise a
+        // worker could finish it first, and the counters would drop to zero
+        // (or wrap around) while other tasks are still running
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++queued;
+            ++unfinished;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        wakeUp.notify_one();
+    }
+
+    /**
+     * @brief   Block until all submitted tasks have finished.
+     *
+     * @throws  If any of the tasks threw an exception, the first one is
+     *          rethrown here.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this] { return unfinished == 0; });
+        if (exception) {
+            std::exception_ptr e = exception;
+            exception            = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    /// Get the number of worker threads.
+    uint size() const { return threads.size(); }
+
+    /// Use all available cores by default.
+    static uint defaultNumThreads() {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+  private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /// Take a task from the back of the worker's own queue.
+    bool tryPop(uint index, Task &task) {
+        WorkQueue &q = *queues[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty())
+            return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    /// Take a task from the front of the queue of another worker.
+    bool trySteal(uint thief, Task &task) {
+        for (uint i = 1; i < queues.size(); ++i) {
+            WorkQueue &q = *queues[(thief + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                continue;
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    /// The main loop of the worker threads.
+    void run(uint index) {
+        while (true) {
+            Task task;
+            if (tryPop(index, task) || trySteal(index, task)) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --queued;
+                }
+                std::exception_ptr e = nullptr;
+                try {
+                    task();
+                } catch (...) {
+                    e = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (e && !exception)
+                    exception = e;
+                if (--unfinished == 0)
+                    allDone.notify_all();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0)
+                return;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<uint> nextQueue = 0;
+
+    /// Protects all members below.
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable allDone;
+    /// The number of tasks that are waiting in one of the queues.
+    size_t queued = 0;
+    /// The number of tasks that have been submitted but haven't finished yet.
+    size_t unfinished = 0;
+    bool stopping     = false;
+    std::exception_ptr exception = nullptr;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Matrix.hpp>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <uint.hpp>
+
+/// Whether the given pixel lies on a grid of lines at an angle of 0.2 rad, 9
+/// pixels wide and 120 pixels apart.
+inline bool onGrid(uint x, uint y) {
+    const float cos = std::cos(0.2f), sin = std::sin(0.2f);
+    auto onLine     = [](float d) { return std::fmod(d + 1200, 120) < 9; };
+    const float u = x * cos + y * sin, v = y * cos - x * sin;
+    return onLine(u) || onLine(v);
+}
+
+/// A 410×308 mask of the grid in #onGrid.
+inline std::unique_ptr<TMatrix<uint8_t, 308, 410>> gridMask() {
+    auto mask = std::make_unique<TMatrix<uint8_t, 308, 410>>();
+    for (uint y = 0; y < 308; ++y)
+        for (uint x = 0; x < 410; ++x)
+            (*mask)[y][x] = onGrid(x, y) ? 0xFF : 0;
+    return mask;
+}
@@ -0,0 +1,76 @@
+#include <AsyncGridFinder.hpp>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "GridMask.hpp"
+
+using GF    = GridFinder<410, 308>;
+using Async = AsyncGridFinder<GF>;
+
+TEST(AsyncGridFinder, findsSquare) {
+    auto mask = gridMask();
+    Async async;
+    Square fromCallback;
+    auto future = async.submit(*mask, [&](const Square &sq) {
+        fromCallback = sq;
+    });
+    Square sq = future.get();
+    EXPECT_EQ(sq.status, SearchStatus::Ok);
+    EXPECT_TRUE(sq.points[3].has_value());
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(fromCallback.points[i], sq.points[i]);
+
+    // The worker is reused for the next request
+    EXPECT_EQ(async.submit(*mask).get().status, SearchStatus::Ok);
+}
+
+TEST(AsyncGridFinder, replacesWaitingRequests) {
+    auto mask = gridMask();
+    Async async;
+    std::atomic<bool> started{false};
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future();
+    // The callback of the first request blocks the worker, so the second one
+    // waits, and is replaced by the third one
+    auto first = async.submit(*mask, [&](const Square &) {
+        started = true;
+        released.wait();
+    });
+    while (!started)
+        std::this_thread::yield();
+    std::vector<SearchStatus> replaced;
+    auto second = async.submit(
+        *mask, [&](const Square &sq) { replaced.push_back(sq.status); });
+    auto third = async.submit(*mask);
+    ASSERT_EQ(second.wait_for(std::chrono::seconds(0)),
+              std::future_status::ready);
+    EXPECT_EQ(second.get().status, SearchStatus::Cancelled);
+    EXPECT_EQ(replaced, std::vector<SearchStatus>{SearchStatus::Cancelled});
+    release.set_value();
+    EXPECT_EQ(first.get().status, SearchStatus::Ok);
+    EXPECT_EQ(third.get().status, SearchStatus::Ok);
+}
+
+TEST(AsyncGridFinder, cancelWhileIdle) {
+    auto mask = gridMask();
+    Async async;
+    async.cancel();
+    EXPECT_EQ(async.submit(*mask).get().status, SearchStatus::Ok);
+}
+
+TEST(AsyncGridFinder, destructorCompletesRequests) {
+    auto mask = gridMask();
+    std::shared_future<Square> future;
+    {
+        Async async;
+        future = async.submit(*mask);
+    }
+    // Either the search finished, or it was cancelled, but it never hangs
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(0)),
+              std::future_status::ready);
+    SearchStatus status = future.get().status;
+    EXPECT_TRUE(status == SearchStatus::Ok ||
+                status == SearchStatus::Cancelled);
+}
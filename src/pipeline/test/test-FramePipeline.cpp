@@ -0,0 +1,120 @@
+#include <FramePipeline.hpp>
+#include <SPSCQueue.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "GridMask.hpp"
+
+TEST(SPSCQueue, pushAndPop) {
+    SPSCQueue<int, 4> queue;
+    int value = -1;
+    EXPECT_FALSE(queue.pop(value));
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.push(i));
+    EXPECT_FALSE(queue.push(4));
+    EXPECT_EQ(queue.size(), 4);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_EQ(value, 3);
+    // Wraps around
+    EXPECT_TRUE(queue.push(42));
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 42);
+}
+
+TEST(SPSCQueue, concurrent) {
+    constexpr uint N = 100000;
+    auto queue       = std::make_unique<SPSCQueue<uint, 16>>();
+    std::thread producer([&] {
+        for (uint i = 0; i < N; ++i)
+            while (!queue->push(i))
+                std::this_thread::yield();
+    });
+    // All elements must arrive in order
+    bool ordered = true;
+    for (uint i = 0; i < N; ++i) {
+        uint value;
+        while (!queue->pop(value))
+            std::this_thread::yield();
+        ordered &= value == i;
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+}
+
+using Pipeline = FramePipeline<410, 308>;
+
+/// The grid of #onGrid in red, on a gray background.
+static std::unique_ptr<Pipeline::RGB_t> gridImage() {
+    auto image  = std::make_unique<Pipeline::RGB_t>();
+    uint8_t *px = image->data();
+    for (uint y = 0; y < 308; ++y) {
+        for (uint x = 0; x < 410; ++x, px += 3) {
+            const bool red = onGrid(x, y);
+            px[0]          = red ? 200 : 120;
+            px[1]          = red ? 30 : 120;
+            px[2]          = red ? 40 : 120;
+        }
+    }
+    return image;
+}
+
+TEST(FramePipeline, redMask) {
+    auto image = gridImage();
+    auto mask  = std::make_unique<Pipeline::Img_t>();
+    Pipeline::redMask(*image, *mask);
+    for (uint y = 0; y < 308; ++y) {
+        for (uint x = 0; x < 410; ++x) {
+            const uint8_t *px = &(*image)[3 * (y * 410 + x)];
+            ASSERT_EQ((*mask)[y][x] != 0, isRed(px[0], px[1], px[2]));
+        }
+    }
+}
+
+TEST(FramePipeline, processesFramesInOrder) {
+    auto image    = gridImage();
+    auto pipeline = std::make_unique<Pipeline>();
+    pipeline->start();
+    constexpr size_t N = 20;
+    size_t pushed = 0, popped = 0;
+    while (popped < N) {
+        if (pushed < N && pipeline->push(image->data()))
+            ++pushed;
+        if (Pipeline::Frame *frame = pipeline->pop()) {
+            EXPECT_EQ(frame->sequence, popped);
+            EXPECT_EQ(frame->square.status, SearchStatus::Ok);
+            EXPECT_TRUE(frame->square.points[3].has_value());
+            pipeline->release(frame);
+            ++popped;
+        }
+    }
+    pipeline->stop();
+    EXPECT_EQ(pipeline->getMaskStats().frames, N);
+    EXPECT_EQ(pipeline->getFinderStats().frames, N);
+    EXPECT_GT(pipeline->getFinderStats().busy, 0);
+}
+
+TEST(FramePipeline, dropsFramesWhenFull) {
+    auto image    = gridImage();
+    auto pipeline = std::make_unique<Pipeline>();
+    // Not started, so the frames are never processed
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_TRUE(pipeline->push(image->data()));
+    EXPECT_FALSE(pipeline->push(image->data()));
+    EXPECT_EQ(pipeline->pop(), nullptr);
+    // The frames that are in flight continue when the pipeline is started
+    pipeline->start();
+    for (size_t i = 0; i < 4; ++i) {
+        Pipeline::Frame *frame;
+        while (!(frame = pipeline->pop()))
+            std::this_thread::yield();
+        EXPECT_EQ(frame->sequence, i);
+        pipeline->release(frame);
+    }
+    EXPECT_TRUE(pipeline->push(image->data()));
+}
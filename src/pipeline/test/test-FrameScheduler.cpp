@@ -0,0 +1,180 @@
+#include <FrameScheduler.hpp>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <future>
+#include <memory>
+#include <vector>
+#include "GridMask.hpp"
+
+using GF        = GridFinder<410, 308>;
+using Scheduler = FrameScheduler<GF>;
+using Result    = Scheduler::Result;
+using Clock     = Scheduler::Clock;
+using std::chrono::seconds;
+
+static std::unique_ptr<GF::Img_t> emptyMask() {
+    auto mask = std::make_unique<GF::Img_t>();
+    for (auto &row : *mask)
+        row.fill(0);
+    return mask;
+}
+
+TEST(FrameScheduler, processesAllStreams) {
+    auto mask = gridMask();
+    std::mutex mutex;
+    std::vector<std::vector<Result>> results(3);
+    Scheduler scheduler = {
+        {{seconds(10)}, {seconds(10)}, {seconds(10)}},
+        [&](const Result &r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.at(r.stream).push_back(r);
+        },
+        4,
+    };
+    for (uint frame = 0; frame < 5; ++frame) {
+        for (uint stream = 0; stream < 3; ++stream)
+            EXPECT_TRUE(scheduler.submit(stream, *mask));
+        scheduler.wait();
+    }
+    for (uint stream = 0; stream < 3; ++stream) {
+        ASSERT_EQ(results[stream].size(), 5);
+        for (size_t i = 0; i < 5; ++i) {
+            const Result &r = results[stream][i];
+            EXPECT_EQ(r.sequence, i);
+            EXPECT_EQ(r.square.status, SearchStatus::Ok);
+            EXPECT_TRUE(r.square.points[3].has_value());
+            EXPECT_FALSE(r.late);
+            EXPECT_LE(r.captured, r.started);
+            EXPECT_LE(r.started, r.finished);
+        }
+        Scheduler::StreamStats stats = scheduler.getStats(stream);
+        EXPECT_EQ(stats.submitted, 5);
+        EXPECT_EQ(stats.processed, 5);
+        EXPECT_EQ(stats.replaced + stats.expired + stats.late, 0);
+        EXPECT_GT(stats.meanLatency().count(), 0);
+        EXPECT_GE(stats.maxLatency, stats.meanLatency());
+    }
+}
+
+TEST(FrameScheduler, deliversResultsInOrder) {
+    auto mask = emptyMask();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future();
+    std::mutex mutex;
+    std::vector<size_t> sequences;
+    std::atomic<bool> firstStarted{false};
+    Scheduler scheduler = {
+        {{seconds(10)}},
+        [&](const Result &r) {
+            if (r.sequence == 0) {
+                firstStarted = true;
+                released.wait();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            sequences.push_back(r.sequence);
+        },
+        2,
+    };
+    // While the callback of the first frame is still running, the second
+    // frame must not be processed by the other worker
+    EXPECT_TRUE(scheduler.submit(0, *mask));
+    while (!firstStarted)
+        std::this_thread::yield();
+    EXPECT_TRUE(scheduler.submit(0, *mask));
+    const auto timeout = Clock::now() + std::chrono::milliseconds(200);
+    while (scheduler.getStats(0).processed < 2 && Clock::now() < timeout)
+        std::this_thread::yield();
+    EXPECT_EQ(scheduler.getStats(0).processed, 1);
+    release.set_value();
+    scheduler.wait();
+    EXPECT_EQ(sequences, (std::vector<size_t>{0, 1}));
+}
+
+TEST(FrameScheduler, replacesWaitingFrames) {
+    auto mask = emptyMask();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future();
+    std::vector<size_t> sequences;
+    Scheduler scheduler = {
+        {{seconds(10)}},
+        [&](const Result &r) {
+            sequences.push_back(r.sequence);
+            released.wait();
+        },
+        1,
+    };
+    // The first frame blocks the only worker, the second one waits, and is
+    // replaced by the third one
+    EXPECT_TRUE(scheduler.submit(0, *mask));
+    while (scheduler.getStats(0).processed == 0)
+        std::this_thread::yield();
+    EXPECT_TRUE(scheduler.submit(0, *mask));
+    EXPECT_FALSE(scheduler.submit(0, *mask));
+    release.set_value();
+    scheduler.wait();
+    EXPECT_EQ(sequences, (std::vector<size_t>{0, 2}));
+    Scheduler::StreamStats stats = scheduler.getStats(0);
+    EXPECT_EQ(stats.submitted, 3);
+    EXPECT_EQ(stats.processed, 2);
+    EXPECT_EQ(stats.replaced, 1);
+}
+
+TEST(FrameScheduler, dropsExpiredFrames) {
+    auto mask   = emptyMask();
+    bool called = false;
+    Scheduler scheduler = {
+        {{std::chrono::milliseconds(10)}},
+        [&](const Result &) { called = true; },
+        1,
+    };
+    scheduler.submit(0, *mask, Clock::now() - seconds(1));
+    scheduler.wait();
+    EXPECT_FALSE(called);
+    EXPECT_EQ(scheduler.getStats(0).expired, 1);
+    EXPECT_EQ(scheduler.getStats(0).processed, 0);
+}
+
+TEST(FrameScheduler, earliestDeadlineFirst) {
+    auto mask = emptyMask();
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future();
+    std::vector<uint> order;
+    Scheduler scheduler = {
+        {{seconds(20)}, {seconds(10)}, {seconds(5)}},
+        [&](const Result &r) {
+            order.push_back(r.stream);
+            if (r.stream == 0)
+                released.wait();
+        },
+        1,
+    };
+    // Keep the only worker busy until the other frames are waiting
+    scheduler.submit(0, *mask);
+    while (scheduler.getStats(0).processed == 0)
+        std::this_thread::yield();
+    scheduler.submit(1, *mask);
+    scheduler.submit(2, *mask);
+    release.set_value();
+    scheduler.wait();
+    EXPECT_EQ(order, (std::vector<uint>{0, 2, 1}));
+}
+
+TEST(FrameScheduler, tracking) {
+    auto grid  = gridMask();
+    auto empty = emptyMask();
+    Scheduler::StreamConfig config;
+    config.deadline     = seconds(10);
+    config.tracking     = true;
+    Scheduler scheduler = {{config}, [](const Result &) {}, 1};
+    const Rect full     = {0, 0, 410, 308};
+
+    scheduler.submit(0, *grid);
+    scheduler.wait();
+    Rect roi = scheduler.getGridFinder(0).getRegionOfInterest();
+    EXPECT_FALSE(roi == full);
+    EXPECT_GT(roi.width, 100);
+
+    scheduler.submit(0, *empty);
+    scheduler.wait();
+    EXPECT_EQ(scheduler.getGridFinder(0).getRegionOfInterest(), full);
+}
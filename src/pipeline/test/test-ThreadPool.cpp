@@ -0,0 +1,62 @@
+#include <ThreadPool.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(ThreadPool, runsAllTasks) {
+    ThreadPool pool = ThreadPool(4);
+    std::atomic<uint> counter = 0;
+    for (uint i = 0; i < 1000; ++i)
+        pool.submit([&] { ++counter; });
+    pool.wait();
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST(ThreadPool, workStealing) {
+    // All long tasks end up in the queue of the first worker, the other
+    // workers have to steal them to finish in time.
+    ThreadPool pool = ThreadPool(2);
+    std::atomic<uint> counter = 0;
+    for (uint i = 0; i < 100; ++i)
+        pool.submit([&, i] {
+            if (i % 2 == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            ++counter;
+        });
+    pool.wait();
+    EXPECT_EQ(counter, 100);
+}
+
+TEST(ThreadPool, rethrowsExceptions) {
+    ThreadPool pool = ThreadPool(2);
+    pool.submit([] { throw std::runtime_error("Error"); });
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    // The pool can still be used afterwards
+    std::atomic<uint> counter = 0;
+    pool.submit([&] { ++counter; });
+    pool.wait();
+    EXPECT_EQ(counter, 1);
+}
+
+TEST(ThreadPool, nestedSubmitStress) {
+    // Tasks that submit more tasks, while two threads wait for all of them.
+    // wait() must not return before the nested tasks have finished.
+    ThreadPool pool = ThreadPool(4);
+    for (uint round = 0; round < 2000; ++round) {
+        std::atomic<uint> counter = 0;
+        for (uint i = 0; i < 4; ++i)
+            pool.submit([&] {
+                for (uint j = 0; j < 4; ++j)
+                    pool.submit([&] { ++counter; });
+                ++counter;
+            });
+        std::atomic<uint> seenByWaiter = 0;
+        std::thread waiter([&] {
+            pool.wait();
+            seenByWaiter = counter.load();
+        });
+        pool.wait();
+        EXPECT_EQ(counter, 20) << round;
+        waiter.join();
+        ASSERT_EQ(seenByWaiter, 20) << round;
+    }
+}
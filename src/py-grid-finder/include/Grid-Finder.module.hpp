@@ -2,14 +2,44 @@
 
 #define TEMPLATE_GRIDFINDER
 
+#include <AsyncGridFinder.hpp>
+#include <FramePipeline.hpp>
 #include <GridFinder.hpp>
 #include <Line.hpp>
+#include <MaskCorpus.hpp>
 #include <PyMatrix.hpp>
+#include <PyramidGridFinder.hpp>
+#include <fstream>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <sstream>
+#include <vector>
+
+/// A corner of a square as seen from Python: an optional (x, y) tuple.
+using PyCorner = std::optional<std::tuple<float, float>>;
+/// A 3×3 matrix as seen from Python: a list of rows.
+using PyMatrix3 = std::array<std::array<float, 3>, 3>;
+
+inline GroundTruth toGroundTruth(const std::array<PyCorner, 4> &corners) {
+    GroundTruth gt;
+    for (size_t i = 0; i < 4; ++i)
+        if (corners[i])
+            gt[i] = Point{std::get<0>(*corners[i]), std::get<1>(*corners[i])};
+    return gt;
+}
+
+inline std::array<PyCorner, 4> fromGroundTruth(const GroundTruth &gt) {
+    std::array<PyCorner, 4> corners;
+    for (size_t i = 0; i < 4; ++i)
+        if (gt[i])
+            corners[i] = std::make_tuple(gt[i]->x, gt[i]->y);
+    return corners;
+}
 
 PYBIND11_MODULE(py_grid_finder, pygridmodule) {
-    using GM = GridFinder<410, 308>;
+    constexpr size_t W = 410;
+    constexpr size_t H = 308;
+    using GM           = GridFinder<W, H>;
     pybind11::class_<GM>(pygridmodule, "GridFinder")
         .def(pybind11::init<const GM::Img_t &>())
         .def("getMaskMatrixCpp", [](const GM &gm) {
@@ -17,12 +47,219 @@ PYBIND11_MODULE(py_grid_finder, pygridmodule) {
             gm.printMaskMatrix(os);
             return os.str();
         })
-        .def("findSquare", &GM::findSquare);
+        .def("findSquare", pybind11::overload_cast<>(&GM::findSquare))
+        .def(
+            "findSquareWithBudget",
+            [](GM &gm, size_t maxSteps, double maxMicroseconds) {
+                SearchBudget budget;
+                if (maxMicroseconds > 0)
+                    budget = SearchBudget::within(
+                        std::chrono::duration_cast<SearchBudget::Clock::duration>(
+                            std::chrono::duration<double, std::micro>(
+                                maxMicroseconds)));
+                if (maxSteps > 0)
+                    budget.limitSteps(maxSteps);
+                return gm.findSquare(budget);
+            },
+            pybind11::arg("maxSteps") = 0, pybind11::arg("maxMicroseconds") = 0)
+        .def("getStepCount", &GM::getStepCount)
+        .def("getHoughCacheStats",
+             [](const GM &gm) {
+                 auto stats = gm.getHoughCacheStats();
+                 return std::make_tuple(stats.hits, stats.misses);
+             })
+        .def("setRegionOfInterest",
+             [](GM &gm, uint x, uint y, uint width, uint height) {
+                 gm.setRegionOfInterest({x, y, width, height});
+             },
+             pybind11::arg("x"), pybind11::arg("y"), pybind11::arg("width"),
+             pybind11::arg("height"))
+        .def("resetRegionOfInterest", &GM::resetRegionOfInterest)
+        .def("checkFrame",
+             [](const GM &gm) { return toString(gm.checkFrame()); })
+        .def("drainDiagnostics",
+             [](GM &gm) {
+                 std::vector<Diagnostic> events;
+                 gm.getDiagnostics().drain(
+                     [&](const Diagnostic &d) { events.push_back(d); });
+                 return events;
+             })
+        .def("getDroppedDiagnosticCount", [](GM &gm) {
+            return gm.getDiagnostics().getDroppedCount();
+        });
+
+    using Params = RuntimeParameters<W, H>;
+    pybind11::class_<Params>(pygridmodule, "Parameters")
+        .def(pybind11::init<>())
+        .def_readwrite("HOUGH_MAX_GAP", &Params::HOUGH_MAX_GAP)
+        .def_readwrite("MAX_GAP", &Params::MAX_GAP)
+        .def_readwrite("MAX_LINE_WIDTH", &Params::MAX_LINE_WIDTH)
+        .def_readwrite("RETRY_JUMP_DISTANCE", &Params::RETRY_JUMP_DISTANCE)
+        .def_readwrite("MINIMUM_START_LINE_WIDTH",
+                       &Params::MINIMUM_START_LINE_WIDTH)
+        .def_readwrite("MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT",
+                       &Params::MINIMIM_START_LINE_WEIGHTED_VOTE_COUNT)
+        .def_readwrite("MAXIMUM_VERTICAL_START_LINE_WIDTH",
+                       &Params::MAXIMUM_VERTICAL_START_LINE_WIDTH)
+        .def_readwrite("FIRST_LINE_INVALID_HORIZONTAL_JUMP",
+                       &Params::FIRST_LINE_INVALID_HORIZONTAL_JUMP)
+        .def_readwrite("MINIMIM_LINE_WEIGHTED_VOTE_COUNT",
+                       &Params::MINIMIM_LINE_WEIGHTED_VOTE_COUNT)
+        .def_readwrite("HOUGH_ANGLE_STEP", &Params::HOUGH_ANGLE_STEP)
+        .def_readwrite("ACCURATE_ANGLE_RANGE", &Params::ACCURATE_ANGLE_RANGE)
+        .def_readwrite("MINIMUM_WHITE_PIXELS", &Params::MINIMUM_WHITE_PIXELS)
+        .def_readwrite("MAXIMUM_WHITE_PERCENTAGE",
+                       &Params::MAXIMUM_WHITE_PERCENTAGE)
+        .def_static("load",
+                    [](const std::string &path) {
+                        std::ifstream file(path);
+                        if (!file)
+                            throw std::runtime_error("Error: unable to open " +
+                                                     path);
+                        return readParameters<W, H>(file);
+                    })
+        .def("save",
+             [](const Params &p, const std::string &path) {
+                 std::ofstream file(path);
+                 file << p;
+                 if (!file)
+                     throw std::runtime_error("Error: unable to write " +
+                                              path);
+             })
+        .def("__str__", [](const Params &p) {
+            std::ostringstream s;
+            s << p;
+            return s.str();
+        });
+
+    using TGM = GridFinder<W, H, Params>;
+    pybind11::class_<TGM>(pygridmodule, "TunableGridFinder")
+        .def(pybind11::init<const TGM::Img_t &, const Params &>(),
+             pybind11::arg("mask"), pybind11::arg("params") = Params())
+        .def("findSquare", pybind11::overload_cast<>(&TGM::findSquare))
+        .def("getStepCount", &TGM::getStepCount)
+        .def("getParameters", &TGM::getParameters)
+        .def("setParameters", &TGM::setParameters);
+
+    using PGM = PyramidGridFinder<W, H, 2>;
+    pybind11::class_<PGM>(pygridmodule, "PyramidGridFinder")
+        .def(pybind11::init<const PGM::Img_t &>())
+        .def("setMask", &PGM::setMask)
+        .def("findSquare", [](PGM &gm) { return gm.findSquare(); })
+        .def("getStepCount", &PGM::getStepCount);
+
+    using FP = FramePipeline<W, H>;
+    using RGBArray =
+        pybind11::array_t<uint8_t, pybind11::array::c_style |
+                                       pybind11::array::forcecast>;
+    // The result of a frame: (sequence number, square, mask)
+    using PipelineResult = std::optional<std::tuple<size_t, Square, GM::Img_t>>;
+    pybind11::class_<FP>(pygridmodule, "FramePipeline")
+        .def(pybind11::init<int, int>(), pybind11::arg("maskCore") = -1,
+             pybind11::arg("finderCore") = -1)
+        .def("start", &FP::start)
+        .def("stop", &FP::stop,
+             pybind11::call_guard<pybind11::gil_scoped_release>())
+        .def("isRunning", &FP::isRunning)
+        .def("push",
+             [](FP &p, RGBArray image) {
+                 if (image.ndim() != 3 || size_t(image.shape(0)) != H ||
+                     size_t(image.shape(1)) != W || image.shape(2) != 3)
+                     throw std::invalid_argument(
+                         "Error: expected an RGB image of 410×308 pixels");
+                 return p.push(image.data());
+             })
+        .def(
+            "pop",
+            [](FP &p, bool wait) -> PipelineResult {
+                FP::Frame *frame;
+                {
+                    pybind11::gil_scoped_release release;
+                    frame = wait ? p.popWait() : p.pop();
+                }
+                if (frame == nullptr)
+                    return std::nullopt;
+                auto result = std::make_tuple(frame->sequence, frame->square,
+                                              frame->mask);
+                p.release(frame);
+                return result;
+            },
+            pybind11::arg("wait") = false)
+        .def("getInFlight", &FP::getInFlight)
+        .def("getStageTimes", [](const FP &p) {
+            auto mask = p.getMaskStats(), finder = p.getFinderStats();
+            return std::make_tuple(std::make_tuple(mask.frames, mask.busy),
+                                   std::make_tuple(finder.frames, finder.busy));
+        });
+
+    // The worker thread takes the GIL to call the callback, so the GIL must
+    // be released while the destructor waits for it.
+    using AGM = AsyncGridFinder<GM>;
+    struct AGMDeleter {
+        void operator()(AGM *p) const {
+            pybind11::gil_scoped_release release;
+            delete p;
+        }
+    };
+    using SquareFuture = std::shared_future<Square>;
+    pybind11::class_<SquareFuture>(pygridmodule, "SquareFuture")
+        .def("done",
+             [](const SquareFuture &f) {
+                 return f.wait_for(std::chrono::seconds(0)) ==
+                        std::future_status::ready;
+             })
+        .def(
+            "result",
+            [](const SquareFuture &f,
+               std::optional<double> timeout) -> std::optional<Square> {
+                pybind11::gil_scoped_release release;
+                if (!timeout)
+                    return f.get();
+                auto wait = std::chrono::duration<double>(*timeout);
+                if (f.wait_for(wait) != std::future_status::ready)
+                    return std::nullopt;
+                return f.get();
+            },
+            pybind11::arg("timeout") = std::nullopt);
+    pybind11::class_<AGM, std::unique_ptr<AGM, AGMDeleter>>(pygridmodule,
+                                                          "AsyncGridFinder")
+        .def(pybind11::init<>())
+        .def(
+            "findSquareAsync",
+            [](AGM &agm, const GM::Img_t &mask,
+               std::optional<pybind11::function> callback,
+               bool cancelRunning) {
+                AGM::Callback cb;
+                if (callback) {
+                    // The function is copied and destroyed on the worker
+                    // thread, which doesn't hold the GIL
+                    std::shared_ptr<pybind11::function> fn(
+                        new pybind11::function(std::move(*callback)),
+                        [](pybind11::function *f) {
+                            pybind11::gil_scoped_acquire gil;
+                            delete f;
+                        });
+                    cb = [fn](const Square &sq) {
+                        pybind11::gil_scoped_acquire gil;
+                        try {
+                            (*fn)(sq);
+                        } catch (pybind11::error_already_set &e) {
+                            e.discard_as_unraisable("findSquareAsync");
+                        }
+                    };
+                }
+                return agm.submit(mask, std::move(cb), cancelRunning);
+            },
+            pybind11::arg("mask"), pybind11::arg("callback") = std::nullopt,
+            pybind11::arg("cancelRunning") = true)
+        .def("cancel", &AGM::cancel);
 
     pybind11::class_<LineResult>(pygridmodule, "LineResult")
         .def("getLineCenter", [](LineResult r) { return r.lineCenter; })
         .def("getWidth", [](LineResult r) { return r.width; })
         .def("getAngle", [](LineResult r) { return r.angle.rad(); })
+        .def("getVotes", [](LineResult r) { return r.votes; })
+        .def("getConfidence", [](LineResult r) { return r.confidence; })
         .def("__str__", [](LineResult r) {
             std::ostringstream s;
             s << r;
@@ -39,12 +276,41 @@ PYBIND11_MODULE(py_grid_finder, pygridmodule) {
     pybind11::class_<Square>(pygridmodule, "Square")
         .def_readonly("lines", &Square::lines)
         .def_readonly("points", &Square::points)
+        .def_readonly("pointConfidence", &Square::pointConfidence)
+        .def_readonly("truncated", &Square::truncated)
+        .def_property_readonly(
+            "homography",
+            [](const Square &sq) -> std::optional<PyMatrix3> {
+                if (!sq.homography)
+                    return std::nullopt;
+                PyMatrix3 m;
+                for (size_t r = 0; r < 3; ++r)
+                    for (size_t c = 0; c < 3; ++c)
+                        m[r][c] = sq.homography->matrix[r][c];
+                return m;
+            })
+        .def_property_readonly(
+            "status", [](const Square &sq) { return toString(sq.status); })
         .def("__str__", [](const Square &sq) {
             std::ostringstream s;
             s << sq;
             return s.str();
         });
 
+    pybind11::class_<Diagnostic>(pygridmodule, "Diagnostic")
+        .def_property_readonly(
+            "event", [](const Diagnostic &d) { return toString(d.event); })
+        .def_readonly("pixel", &Diagnostic::pixel)
+        .def_property_readonly(
+            "angle", [](const Diagnostic &d) { return d.angle.rad(); })
+        .def_readonly("value", &Diagnostic::value)
+        .def("__str__", [](const Diagnostic &d) {
+            std::ostringstream s;
+            s << toString(d.event) << " at " << d.pixel << ", " << d.angle
+              << ": " << d.value;
+            return s.str();
+        });
+
     pybind11::class_<Pixel>(pygridmodule, "Pixel")
         .def_readwrite("x", &Pixel::x)
         .def_readwrite("y", &Pixel::y)
@@ -62,4 +328,44 @@ PYBIND11_MODULE(py_grid_finder, pygridmodule) {
             s << p;
             return s.str();
         });
+
+    pybind11::class_<MaskCorpusWriter>(pygridmodule, "MaskCorpusWriter")
+        .def(pybind11::init([](const std::string &path, bool withGroundTruth) {
+                 return std::make_unique<MaskCorpusWriter>(
+                     path, uint(W), uint(H), withGroundTruth);
+             }),
+             pybind11::arg("path"), pybind11::arg("withGroundTruth") = false)
+        .def(
+            "append",
+            [](MaskCorpusWriter &w, const GM::Img_t &mask,
+               const std::array<PyCorner, 4> &groundTruth) {
+                w.append(mask, toGroundTruth(groundTruth));
+            },
+            pybind11::arg("mask"),
+            pybind11::arg("groundTruth") = std::array<PyCorner, 4>{})
+        .def("close", &MaskCorpusWriter::close)
+        .def("__len__", &MaskCorpusWriter::size)
+        .def("__enter__", [](MaskCorpusWriter &w) -> MaskCorpusWriter & {
+            return w;
+        })
+        .def("__exit__", [](MaskCorpusWriter &w, pybind11::args) {
+            w.close();
+        });
+
+    pybind11::class_<MaskCorpus>(pygridmodule, "MaskCorpus")
+        .def(pybind11::init<const std::string &>())
+        .def("__len__", &MaskCorpus::size)
+        .def("getMask",
+             [](const MaskCorpus &c, size_t i) {
+                 if (i >= c.size())
+                     throw pybind11::index_error();
+                 GM::Img_t mask;
+                 c[i].unpack(mask);
+                 return mask;
+             })
+        .def("getGroundTruth", [](const MaskCorpus &c, size_t i) {
+            if (i >= c.size())
+                throw pybind11::index_error();
+            return fromGroundTruth(c.groundTruth(i));
+        });
 }
\ No newline at end of file